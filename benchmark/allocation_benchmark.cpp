@@ -0,0 +1,73 @@
+#include<benchmark/benchmark.h>
+#include"../test/allocation_counter.hpp"
+#include"dataset_generator.hpp"
+#include<turbo_csv.hpp>
+#include<string>
+
+// Reports the allocations and allocated bytes per record of every reader configuration. Kept apart from
+// read_benchmark as counting every allocation slows down the throughput benchmarks
+
+using namespace turbo_csv::benchmarks;
+
+namespace {
+
+    constexpr std::uint64_t dataset_bytes = 8 << 20;
+
+    void set_allocation_counters(benchmark::State& state, turbo_csv::testing::allocation_counts counts, std::uint64_t rows) {
+        state.counters["allocs/row"] = static_cast<double>(counts.allocations) / static_cast<double>(rows);
+        state.counters["bytes/row"] = static_cast<double>(counts.bytes) / static_cast<double>(rows);
+        state.counters["rows/s"] = benchmark::Counter(static_cast<double>(rows), benchmark::Counter::kIsRate);
+    }
+
+    template<typename Reader>
+    void retained(benchmark::State& state, std::string path) {
+        std::uint64_t rows = 0;
+        turbo_csv::testing::allocation_scope scope;
+        for (auto _ : state) {
+            Reader csv_reader(path);
+            for (auto& record : csv_reader) {
+                record.get_fields();
+                rows++;
+            }
+        }
+        set_allocation_counters(state, scope.get(), rows);
+    }
+
+    template<typename Reader>
+    void streamed(benchmark::State& state, std::string path) {
+        std::uint64_t rows = 0;
+        turbo_csv::basic_record<turbo_csv::dialect> record;
+        turbo_csv::testing::allocation_scope scope;
+        for (auto _ : state) {
+            Reader csv_reader(path);
+            while (csv_reader.next(record)) {
+                record.get_fields();
+                rows++;
+            }
+        }
+        set_allocation_counters(state, scope.get(), rows);
+    }
+
+    void register_benchmarks() {
+        const dataset_kind kinds[] = { dataset_kind::narrow, dataset_kind::wide, dataset_kind::quote_heavy,
+            dataset_kind::numeric, dataset_kind::multiline };
+        for (auto kind : kinds) {
+            std::string name = dataset_name(kind);
+            auto path = generate_dataset(kind, dataset_bytes).string();
+            benchmark::RegisterBenchmark(("reader/" + name).c_str(), retained<turbo_csv::reader>, path)->Unit(benchmark::kMillisecond);
+            benchmark::RegisterBenchmark(("experimental_reader/" + name).c_str(), retained<turbo_csv::experimental_reader>, path)->Unit(benchmark::kMillisecond);
+            benchmark::RegisterBenchmark(("reader_streaming/" + name).c_str(), streamed<turbo_csv::reader>, path)->Unit(benchmark::kMillisecond);
+            benchmark::RegisterBenchmark(("experimental_reader_streaming/" + name).c_str(), streamed<turbo_csv::experimental_reader>, path)->Unit(benchmark::kMillisecond);
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) { return 1; }
+    register_benchmarks();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
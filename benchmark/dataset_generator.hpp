@@ -0,0 +1,186 @@
+#ifndef DATASET_GENERATOR_HPP
+#define DATASET_GENERATOR_HPP
+
+#include<array>
+#include<random>
+#include<string>
+#include<cstdlib>
+#include<fstream>
+#include<filesystem>
+#include<string_view>
+
+namespace turbo_csv::benchmarks {
+
+    /**
+     * @brief Shapes of the generated datasets
+     *
+     * narrow      : 4 short columns (year, two words, decimal) like cars.csv
+     * wide        : 64 short columns
+     * quote_heavy : 8 columns, half of them quoted with embedded seperators and doubled quotes
+     * numeric     : 12 integer/decimal columns
+     * multiline   : 6 columns, one quoted field spanning multiple lines
+     */
+    enum class dataset_kind { narrow, wide, quote_heavy, numeric, multiline };
+
+    inline const char* dataset_name(dataset_kind kind) {
+        switch (kind) {
+        case dataset_kind::narrow: return "narrow";
+        case dataset_kind::wide: return "wide";
+        case dataset_kind::quote_heavy: return "quote_heavy";
+        case dataset_kind::numeric: return "numeric";
+        case dataset_kind::multiline: return "multiline";
+        }
+        return "unknown";
+    }
+
+    /**
+     * @brief Writes deterministic csv rows of a given shape. The engine output is used directly (the standard
+     * distributions are implementation defined) so that the same bytes are produced on every platform
+     *
+     */
+    class dataset_generator {
+        std::mt19937_64 engine;
+        dataset_kind kind;
+
+        static constexpr std::array<std::string_view, 12> words = {
+            "Ford", "Maruti Suzuki", "Fiesta", "Brezza", "Agriculture", "Forestry",
+            "Fishing", "Mining", "Construction", "Retail", "Transport", "Education" };
+
+    public:
+        // Part of the cached dataset names, bump it whenever append_record produces different bytes for a seed
+        static constexpr int version = 1;
+
+        dataset_generator(dataset_kind kind, std::uint64_t seed = 42) :engine(seed), kind(kind) {}
+
+        /**
+         * @brief Appends one record (terminated by a record seperator) to out
+         *
+         * @param out buffer the record is appended to
+         */
+        void append_record(std::string& out) {
+            switch (kind) {
+            case dataset_kind::narrow:
+                append_integer(out, 1990 + next(35));
+                out.push_back(',');
+                out.append(word());
+                out.push_back(',');
+                out.append(word());
+                out.push_back(',');
+                append_decimal(out, next(100000));
+                break;
+            case dataset_kind::wide:
+                for (int column = 0; column < 64; column++) {
+                    if (column != 0) { out.push_back(','); }
+                    if (column % 2 == 0) { append_integer(out, next(1000)); }
+                    else { out.append(word().substr(0, 3)); }
+                }
+                break;
+            case dataset_kind::quote_heavy:
+                for (int column = 0; column < 8; column++) {
+                    if (column != 0) { out.push_back(','); }
+                    if (column % 2 == 0) { append_integer(out, next(100000)); continue; }
+                    out.push_back('"');
+                    out.append(word());
+                    out.append(", ");
+                    out.append(word());
+                    if (next(4) == 0) { out.append(" \"\"quoted\"\""); }
+                    out.push_back('"');
+                }
+                break;
+            case dataset_kind::numeric:
+                for (int column = 0; column < 12; column++) {
+                    if (column != 0) { out.push_back(','); }
+                    if (column % 3 == 0) { append_integer(out, next(1000000)); }
+                    else { append_decimal(out, next(100000000)); }
+                }
+                break;
+            case dataset_kind::multiline:
+                append_integer(out, next(1000000));
+                out.append(",");
+                out.append(word());
+                out.append(",\"");
+                for (std::uint64_t line = 0, lines = 1 + next(3); line < lines; line++) {
+                    if (line != 0) { out.push_back('\n'); }
+                    out.append(word());
+                    out.push_back(' ');
+                    out.append(word());
+                }
+                out.append("\",");
+                append_decimal(out, next(100000));
+                out.push_back(',');
+                out.append(word());
+                out.push_back(',');
+                append_integer(out, next(100));
+                break;
+            }
+            out.push_back('\n');
+        }
+
+    private:
+        std::uint64_t next(std::uint64_t bound) {
+            return engine() % bound;
+        }
+
+        std::string_view word() {
+            return words[next(words.size())];
+        }
+
+        static void append_integer(std::string& out, std::uint64_t value) {
+            out.append(std::to_string(value));
+        }
+
+        static void append_decimal(std::string& out, std::uint64_t value) {
+            out.append(std::to_string(value / 100));
+            out.push_back('.');
+            out.push_back(static_cast<char>('0' + value / 10 % 10));
+            out.push_back(static_cast<char>('0' + value % 10));
+        }
+    };
+
+    /**
+     * @brief Directory the datasets are generated in (TURBO_CSV_BENCHMARK_DIR or the temp directory)
+     *
+     * @return std::filesystem::path
+     */
+    inline std::filesystem::path dataset_directory() {
+        if (auto directory = std::getenv("TURBO_CSV_BENCHMARK_DIR")) { return directory; }
+        return std::filesystem::temp_directory_path();
+    }
+
+    /**
+     * @brief Generates a dataset of at least target_bytes bytes unless it was generated before. The contents only
+     * depend on the generator version, kind, seed and size which are all part of the file name, so an existing file
+     * is reused across runs
+     *
+     * @param kind shape of the dataset
+     * @param target_bytes minimum size of the dataset
+     * @param seed seed of the generator
+     * @return std::filesystem::path path of the generated csv file
+     */
+    inline std::filesystem::path generate_dataset(dataset_kind kind, std::uint64_t target_bytes, std::uint64_t seed = 42) {
+        auto path = dataset_directory() / ("turbo_csv_bench_v" + std::to_string(dataset_generator::version) + "_" +
+            dataset_name(kind) + "_s" + std::to_string(seed) + "_" + std::to_string(target_bytes) + ".csv");
+        if (std::filesystem::exists(path) && std::filesystem::file_size(path) >= target_bytes) { return path; }
+
+        // Written under a temporary name so that an interrupted run does not leave a truncated dataset behind
+        auto partial_path = path;
+        partial_path += ".partial";
+        {
+            std::ofstream file(partial_path, std::ios::binary | std::ios::trunc);
+            dataset_generator generator(kind, seed);
+            std::string block;
+            std::uint64_t written = 0;
+            while (written < target_bytes) {
+                block.clear();
+                while (block.size() < (1 << 20)) { generator.append_record(block); }
+                file.write(block.data(), static_cast<std::streamsize>(block.size()));
+                written += block.size();
+            }
+        }
+        std::filesystem::rename(partial_path, path);
+        return path;
+    }
+
+}
+
+#endif
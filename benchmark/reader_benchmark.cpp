@@ -1,58 +1,202 @@
 #include<benchmark/benchmark.h>
+#include<turbo_csv.hpp>
 #include<csv_file_reader.hpp>
-#include<sstream>
+#include"dataset_generator.hpp"
+#include<vector>
+#include<string>
+#include<cstdlib>
+#include<fstream>
 
-auto examples_dir(){
-    return std::string(EXAMPLES);
-}
+// Sizes of the generated datasets can be changed with
+//  TURBO_CSV_BENCHMARK_MB       : size of the datasets used by the streaming benchmarks ( default 64 )
+//  TURBO_CSV_BENCHMARK_LARGE_GB : additionally benchmarks parser::next on a dataset of this many GB
+//  TURBO_CSV_BENCHMARK_DIR      : directory the datasets are generated in ( default temp directory )
+// Results can be exported with --benchmark_format=json or --benchmark_out=results.json
+
+using namespace turbo_csv::benchmarks;
+
+namespace {
+
+    std::uint64_t env_size(const char* name, std::uint64_t default_value) {
+        auto value = std::getenv(name);
+        return value != nullptr ? std::strtoull(value, nullptr, 10) : default_value;
+    }
 
-static void seq_fstream_read(benchmark::State& state){
-    std::fstream file(examples_dir()+"business_price_index.csv");
-    for(auto _ :state){
-        std::string data;
-        data.reserve(12000000); ////Change if testing on different file to avoid allocation time
-        benchmark::DoNotOptimize(data);
-        char c;
-        while(file.get(c)){
-            data.push_back(c);
+    // Records kept in memory by the benchmarks that do not measure parsing
+    constexpr std::uint64_t in_memory_dataset_bytes = 8 << 20;
+    // get_column deserializes every field with std::async, hence a smaller dataset
+    constexpr std::uint64_t column_dataset_bytes = 1 << 20;
+
+    void set_throughput(benchmark::State& state, std::uint64_t bytes, std::uint64_t rows) {
+        state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+        state.counters["rows/s"] = benchmark::Counter(static_cast<double>(rows), benchmark::Counter::kIsRate);
+    }
+
+    std::vector<turbo_csv::basic_record<turbo_csv::dialect>> load_records(const std::string& path, std::uint64_t& bytes) {
+        turbo_csv::reader csv_reader(path);
+        std::vector<turbo_csv::basic_record<turbo_csv::dialect>> records;
+        bytes = 0;
+        for (auto& record : csv_reader.stream()) {
+            bytes += record.get_raw_size();
+            records.push_back(record);
         }
+        return records;
     }
-    
-}
 
-static void parallel_buffered_file_reader(benchmark::State& state){
-    turbo_csv::file_reader<1000000> my_reader(examples_dir()+"business_price_index.csv");
-    for(auto _ : state){
-        std::string data;
-        data.reserve(12000000);//Change if testing on different file to avoid allocation time
-        benchmark::DoNotOptimize(data);
-        std::optional<std::uint8_t> c;
-        while(true){
-            c= my_reader.get_byte();
-            if(c.has_value()){data.push_back(c.value());}
-            else{break;}
+    void raw_fstream_read(benchmark::State& state, std::string path) {
+        std::uint64_t bytes = 0;
+        std::vector<char> buffer(1 << 20);
+        for (auto _ : state) {
+            std::ifstream file(path, std::ios::binary);
+            while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() != 0) {
+                bytes += static_cast<std::uint64_t>(file.gcount());
+                benchmark::DoNotOptimize(buffer.data());
+            }
         }
+        state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+    }
 
+    void parallel_buffered_file_reader(benchmark::State& state, std::string path) {
+        std::uint64_t bytes = 0;
+        for (auto _ : state) {
+            turbo_csv::file_reader<1000000> csv_file(path);
+            std::uint64_t checksum = 0;
+            while (auto byte = csv_file.get_byte()) {
+                checksum += byte.value();
+                bytes++;
+            }
+            benchmark::DoNotOptimize(checksum);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+    }
+
+    template<typename FileReader>
+    void parser_next(benchmark::State& state, std::string path) {
+        std::uint64_t bytes = 0, rows = 0;
+        turbo_csv::basic_record<turbo_csv::dialect> record;
+        for (auto _ : state) {
+            turbo_csv::parser<FileReader, turbo_csv::dialect> csv_parser(path);
+            while (csv_parser.next(record)) {
+                bytes += record.get_raw_size() + 1;
+                rows++;
+            }
+        }
+        set_throughput(state, bytes, rows);
+    }
+
+    // Includes copying the record into a reused record as that is the only way to drop its cached fields
+    void generate_metadata(benchmark::State& state, std::string path) {
+        std::uint64_t dataset_bytes;
+        auto records = load_records(path, dataset_bytes);
+        turbo_csv::basic_record<turbo_csv::dialect> scratch;
+        for (auto _ : state) {
+            for (auto& record : records) {
+                scratch = record;
+                benchmark::DoNotOptimize(scratch.get_field_count());
+            }
+        }
+        set_throughput(state, dataset_bytes * state.iterations(), records.size() * state.iterations());
+    }
+
+    template<typename T>
+    void get_field(benchmark::State& state, std::string path) {
+        std::uint64_t dataset_bytes;
+        auto records = load_records(path, dataset_bytes);
+        for (auto& record : records) { record.get_fields(); }
+        for (auto _ : state) {
+            for (auto& record : records) {
+                for (int column = 0, columns = static_cast<int>(record.get_field_count()); column < columns; column++) {
+                    benchmark::DoNotOptimize(record.get_field<T>(column, true, true));
+                }
+            }
+        }
+        set_throughput(state, dataset_bytes * state.iterations(), records.size() * state.iterations());
+    }
+
+    void get_column(benchmark::State& state, std::string path) {
+        std::uint64_t rows = 0;
+        for (auto _ : state) {
+            turbo_csv::reader csv_reader(path);
+            auto column = csv_reader.get_column<double>(1);
+            rows += column.size();
+            benchmark::DoNotOptimize(column.data());
+        }
+        set_throughput(state, std::filesystem::file_size(path) * state.iterations(), rows);
     }
-}
 
-static void rd_buf_fstream_read(benchmark::State& state){
-    std::fstream file(examples_dir()+"business_price_index.csv");
-    for(auto _:state){
-        std::string data;
-        data.reserve(21000000);//Change if testing on different file to avoid allocation time
-        benchmark::DoNotOptimize(data);
-        char c;
-        std::stringstream ss;
-        ss<<file.rdbuf();
-        while(ss.get(c)){
-            data.push_back(c);
+    void get_totalrecords(benchmark::State& state, std::string path) {
+        std::uint64_t rows = 0;
+        for (auto _ : state) {
+            turbo_csv::reader csv_reader(path);
+            rows += csv_reader.get_totalrecords();
+        }
+        set_throughput(state, std::filesystem::file_size(path) * state.iterations(), rows);
+    }
+
+    // Random access to records already held by the reader
+    void random_access(benchmark::State& state, std::string path) {
+        turbo_csv::reader csv_reader(path);
+        auto total_records = csv_reader.get_totalrecords();
+        std::mt19937_64 engine(7);
+        std::vector<std::size_t> indices(1 << 16);
+        for (auto& index : indices) { index = engine() % total_records; }
+
+        std::uint64_t bytes = 0, rows = 0;
+        for (auto _ : state) {
+            for (auto index : indices) {
+                auto& record = csv_reader[index];
+                benchmark::DoNotOptimize(record[0]);
+                bytes += record.get_raw_size();
+            }
+            rows += indices.size();
+        }
+        set_throughput(state, bytes, rows);
+    }
+
+    void register_benchmarks() {
+        auto dataset_bytes = env_size("TURBO_CSV_BENCHMARK_MB", 64) << 20;
+        const dataset_kind kinds[] = { dataset_kind::narrow, dataset_kind::wide, dataset_kind::quote_heavy,
+            dataset_kind::numeric, dataset_kind::multiline };
+
+        auto narrow = generate_dataset(dataset_kind::narrow, dataset_bytes).string();
+        benchmark::RegisterBenchmark("raw_fstream_read/narrow", raw_fstream_read, narrow)->Unit(benchmark::kMillisecond);
+        benchmark::RegisterBenchmark("parallel_buffered_file_reader/narrow", parallel_buffered_file_reader, narrow)->Unit(benchmark::kMillisecond);
+
+        for (auto kind : kinds) {
+            std::string name = dataset_name(kind);
+            auto streamed = generate_dataset(kind, dataset_bytes).string();
+            auto in_memory = generate_dataset(kind, in_memory_dataset_bytes).string();
+
+            benchmark::RegisterBenchmark(("parser_next/fstream/" + name).c_str(), parser_next<turbo_csv::adapted_fstream>, streamed)->Unit(benchmark::kMillisecond);
+            benchmark::RegisterBenchmark(("parser_next/file_reader/" + name).c_str(), parser_next<turbo_csv::file_reader<1000000>>, streamed)->Unit(benchmark::kMillisecond);
+            benchmark::RegisterBenchmark(("generate_metadata/" + name).c_str(), generate_metadata, in_memory)->Unit(benchmark::kMillisecond);
+            benchmark::RegisterBenchmark(("get_totalrecords/" + name).c_str(), get_totalrecords, in_memory)->Unit(benchmark::kMillisecond);
+            benchmark::RegisterBenchmark(("random_access/" + name).c_str(), random_access, in_memory)->Unit(benchmark::kMillisecond);
+            if (kind == dataset_kind::numeric) {
+                benchmark::RegisterBenchmark(("get_field<double>/" + name).c_str(), get_field<double>, in_memory)->Unit(benchmark::kMillisecond);
+            }
+            else {
+                benchmark::RegisterBenchmark(("get_field<std::string>/" + name).c_str(), get_field<std::string>, in_memory)->Unit(benchmark::kMillisecond);
+            }
+        }
+
+        auto column_dataset = generate_dataset(dataset_kind::numeric, column_dataset_bytes).string();
+        benchmark::RegisterBenchmark("get_column<double>/numeric", get_column, column_dataset)->Unit(benchmark::kMillisecond);
+
+        if (auto large_gb = env_size("TURBO_CSV_BENCHMARK_LARGE_GB", 0)) {
+            auto large = generate_dataset(dataset_kind::narrow, large_gb << 30).string();
+            benchmark::RegisterBenchmark("parser_next/file_reader/narrow_large", parser_next<turbo_csv::file_reader<1000000>>, large)
+                ->Unit(benchmark::kMillisecond)->Iterations(1);
         }
-        
     }
 
 }
 
-BENCHMARK(seq_fstream_read)->Unit(benchmark::kMillisecond);
-BENCHMARK(parallel_buffered_file_reader)->Unit(benchmark::kMillisecond);
-BENCHMARK(rd_buf_fstream_read)->Unit(benchmark::kMillisecond);
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) { return 1; }
+    register_benchmarks();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
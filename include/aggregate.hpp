@@ -0,0 +1,173 @@
+#ifndef AGGREGATE_HPP
+#define AGGREGATE_HPP
+
+#include<limits>
+#include<string>
+#include<thread>
+#include<vector>
+#include<algorithm>
+#include<string_view>
+#include<unordered_map>
+#include<turbo_csv.hpp>
+#include<field_utils.hpp>
+#include<batch_pipeline.hpp>
+
+namespace turbo_csv {
+
+    /**
+     * @brief count/sum/min/max/mean of the numeric values of a column inside a group
+     *
+     */
+    struct column_aggregate {
+        std::size_t count = 0;
+        double sum = 0;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+
+        /**
+         * @brief Returns the mean of the values (NaN if the group has no numeric value)
+         *
+         * @return double mean of the values
+         */
+        double mean() const {
+            return count == 0 ? std::numeric_limits<double>::quiet_NaN() : sum / static_cast<double>(count);
+        }
+
+        void add(double value) {
+            ++count;
+            sum += value;
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+
+        void merge(const column_aggregate& other) {
+            count += other.count;
+            sum += other.sum;
+            min = std::min(min, other.min);
+            max = std::max(max, other.max);
+        }
+    };
+
+    /**
+     * @brief Aggregates of one group
+     *
+     * keys   : values of the key columns (in the order of key_columns)
+     * count  : number of records in the group
+     * values : aggregates of the value columns (in the order of value_columns). Fields that are
+     *          empty or not numbers are not part of the aggregate
+     */
+    struct group_aggregate {
+        std::vector<std::string> keys;
+        std::size_t count = 0;
+        std::vector<column_aggregate> values;
+    };
+
+    /**
+     * @brief Groups the remaining records of the reader by the key columns and aggregates the value columns.
+     * Records are streamed through the reader (not retained) and aggregated by thread_count threads into
+     * thread local hash tables which are merged at the end
+     *
+     * @param csv_reader reader whose remaining records are aggregated
+     * @param key_columns indices of the columns to group by
+     * @param value_columns indices of the columns to aggregate
+     * @param thread_count number of aggregating threads
+     * @param batch_size number of records handed to a thread at once
+     * @return std::vector<group_aggregate> groups sorted by their keys
+     */
+    template<template<class,class>class Parser,class FileReader,class Dialect>
+    std::vector<group_aggregate> group_by(basic_reader<Parser,FileReader,Dialect>& csv_reader,
+        const std::vector<std::size_t>& key_columns, const std::vector<std::size_t>& value_columns,
+        std::size_t thread_count = std::thread::hardware_concurrency(), std::size_t batch_size = 1024) {
+
+        // Keys are views into a per thread arena ( which outlives the merge ), looking them up never allocates
+        using group_table = std::unordered_map<std::string_view, group_aggregate, string_hash, std::equal_to<>>;
+
+        thread_count = std::max<std::size_t>(thread_count, 1);
+        std::vector<group_table> partial_tables(thread_count);
+        std::vector<string_arena> key_arenas(thread_count);
+        // Composite keys are built into a per thread scratch buffer that is reused for every record
+        std::vector<std::string> key_scratch(thread_count);
+
+        auto required_fields = std::max(
+            key_columns.empty() ? 0 : *std::max_element(key_columns.begin(), key_columns.end()) + 1,
+            value_columns.empty() ? 0 : *std::max_element(value_columns.begin(), value_columns.end()) + 1);
+
+        auto aggregate_batch = [&](std::size_t worker_index, std::vector<basic_record<Dialect>>& batch) {
+            auto& table = partial_tables[worker_index];
+            auto& scratch = key_scratch[worker_index];
+            auto escape_character = Dialect::get_escapecharacter();
+
+            for (auto& record : batch) {
+                auto& fields = record.get_fields();
+                if (fields.size() < required_fields) { continue; }
+
+                std::string_view key;
+                if (key_columns.size() == 1) {
+                    key = trim_field(fields[key_columns.front()], escape_character);
+                }
+                else {
+                    // Length prefixed so that different splits of the same characters never collide
+                    scratch.clear();
+                    for (auto column : key_columns) {
+                        auto field = trim_field(fields[column], escape_character);
+                        auto length = static_cast<std::uint32_t>(field.size());
+                        scratch.append(reinterpret_cast<const char*>(&length), sizeof(length));
+                        scratch.append(field);
+                    }
+                    key = scratch;
+                }
+
+                auto group = table.find(key);
+                if (group == table.end()) {
+                    group_aggregate new_group;
+                    for (auto column : key_columns) {
+                        new_group.keys.emplace_back(trim_field(fields[column], escape_character));
+                    }
+                    new_group.values.resize(value_columns.size());
+                    group = table.emplace(key_arenas[worker_index].store(key), std::move(new_group)).first;
+                }
+
+                auto& aggregate = group->second;
+                ++aggregate.count;
+                for (std::size_t i = 0; i < value_columns.size(); i++) {
+                    double value;
+                    if (parse_number(fields[value_columns[i]], value, escape_character)) {
+                        aggregate.values[i].add(value);
+                    }
+                }
+            }
+        };
+
+        process_batches<Dialect>([&csv_reader](basic_record<Dialect>& record) {return csv_reader.next(record);},
+            thread_count, batch_size, aggregate_batch);
+
+        // Merge the partial tables into the first one
+        auto& merged = partial_tables.front();
+        for (std::size_t i = 1; i < partial_tables.size(); i++) {
+            for (auto& [key, partial] : partial_tables[i]) {
+                auto group = merged.find(key);
+                if (group == merged.end()) {
+                    merged.emplace(key, std::move(partial));
+                    continue;
+                }
+                group->second.count += partial.count;
+                for (std::size_t column = 0; column < partial.values.size(); column++) {
+                    group->second.values[column].merge(partial.values[column]);
+                }
+            }
+        }
+
+        std::vector<group_aggregate> groups;
+        groups.reserve(merged.size());
+        for (auto& entry : merged) {
+            groups.push_back(std::move(entry.second));
+        }
+        std::sort(groups.begin(), groups.end(), [](const group_aggregate& lhs, const group_aggregate& rhs) {
+            return lhs.keys < rhs.keys;
+        });
+        return groups;
+    }
+
+}
+
+#endif
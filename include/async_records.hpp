@@ -0,0 +1,257 @@
+#ifndef ASYNC_RECORDS_HPP
+#define ASYNC_RECORDS_HPP
+
+#include<deque>
+#include<mutex>
+#include<thread>
+#include<vector>
+#include<utility>
+#include<algorithm>
+#include<exception>
+#include<coroutine>
+#include<functional>
+#include<condition_variable>
+#include<memory>
+#include<turbo_csv.hpp>
+#include<thread_placement.hpp>
+
+namespace turbo_csv {
+
+    /**
+     * @brief Parameters of an async record stream
+     *
+     * batch_size       : number of records parsed ahead at once
+     * prefetch_batches : parsed batches waiting for the coroutine after which reading pauses
+     */
+    struct async_options {
+        std::size_t batch_size = 1024;
+        std::size_t prefetch_batches = 2;
+    };
+
+    /**
+     * @brief Records of a reader handed to a coroutine. Reading and parsing run on a background thread, so the
+     * coroutine never blocks on the file : co_await suspends it until the next batch is parsed and the awaiting
+     * coroutine is handed to a resume function ( eg. posted back to the event loop that owns it )
+     *
+     * @tparam Dialect dialect of the records
+     */
+    template<typename Dialect>
+    class async_record_stream {
+    public:
+        using record_batch = std::vector<basic_record<Dialect>>;
+        using next_record_function = std::function<bool(basic_record<Dialect>&)>;
+        using resume_function = std::function<void(std::coroutine_handle<>)>;
+
+    private:
+        next_record_function next_record;
+        resume_function resume;
+        async_options options;
+
+        // Guarded by batches_resx
+        std::deque<record_batch> ready_batches;
+        std::vector<record_batch> free_batches;
+        std::coroutine_handle<> waiting;
+        bool reached_end = false;
+        bool stop_reading = false;
+        std::exception_ptr read_error;
+
+        std::mutex batches_resx;
+        std::condition_variable batches_changed;
+
+        // Batch handed to the coroutine and the position of the next record inside it ( coroutine side )
+        record_batch current;
+        std::size_t current_position = 0;
+
+        std::thread reading_thread;
+
+    public:
+        /**
+         * @brief Awaitable returned by next_batch ( and used by next )
+         *
+         */
+        class batch_awaiter {
+            async_record_stream& stream;
+        public:
+            batch_awaiter(async_record_stream& stream) :stream(stream) {}
+
+            bool await_ready() {
+                std::lock_guard<std::mutex> lck(stream.batches_resx);
+                return stream.reached_end || !stream.ready_batches.empty();
+            }
+
+            bool await_suspend(std::coroutine_handle<> handle) {
+                std::lock_guard<std::mutex> lck(stream.batches_resx);
+                // A batch may have been parsed since await_ready
+                if (stream.reached_end || !stream.ready_batches.empty()) { return false; }
+                stream.waiting = handle;
+                return true;
+            }
+
+            /**
+             * @return record_batch* next batch/nullptr once all records are read
+             * @throw Rethrows the exception thrown while reading
+             */
+            record_batch* await_resume() {
+                return stream.take_batch();
+            }
+        };
+
+        /**
+         * @brief Awaitable returned by next, it only suspends once the current batch is exhausted
+         *
+         */
+        class record_awaiter {
+            async_record_stream& stream;
+            batch_awaiter awaiter;
+        public:
+            record_awaiter(async_record_stream& stream) :stream(stream), awaiter(stream) {}
+
+            bool await_ready() {
+                return stream.current_position < stream.current.size() || awaiter.await_ready();
+            }
+
+            bool await_suspend(std::coroutine_handle<> handle) {
+                return awaiter.await_suspend(handle);
+            }
+
+            /**
+             * @return basic_record<Dialect>* next record/nullptr once all records are read. Valid until the
+             * next call to next or next_batch
+             * @throw Rethrows the exception thrown while reading
+             */
+            basic_record<Dialect>* await_resume() {
+                if (stream.current_position == stream.current.size() && awaiter.await_resume() == nullptr) {
+                    return nullptr;
+                }
+                return &stream.current[stream.current_position++];
+            }
+        };
+
+        /**
+         * @brief Starts reading ahead on a background thread
+         *
+         * @param next_record callable refilling a record with the next row, only called from the background thread
+         * @param resume called from the background thread with the suspended coroutine once a batch is ready, it
+         * should post the handle to the thread owning the coroutine rather than resume it inline
+         * @param options batch size and read ahead
+         */
+        async_record_stream(next_record_function next_record, resume_function resume, const async_options& options = {}) :
+            next_record(std::move(next_record)), resume(std::move(resume)), options(options) {
+            this->options.batch_size = std::max<std::size_t>(options.batch_size, 1);
+            this->options.prefetch_batches = std::max<std::size_t>(options.prefetch_batches, 1);
+            reading_thread = std::thread([this, reading_placement = placement::helper_placement()]() {
+                reading_placement.apply();
+                read_batches();
+            });
+        }
+
+        async_record_stream(const async_record_stream&) = delete;
+        async_record_stream& operator=(const async_record_stream&) = delete;
+
+        ~async_record_stream() {
+            {
+                std::lock_guard<std::mutex> lck(batches_resx);
+                stop_reading = true;
+            }
+            batches_changed.notify_all();
+            if (reading_thread.joinable()) { reading_thread.join(); }
+        }
+
+        /**
+         * @brief Returns an awaitable yielding the next record ( co_await stream.next() )
+         *
+         * @return record_awaiter
+         */
+        record_awaiter next() {
+            return record_awaiter(*this);
+        }
+
+        /**
+         * @brief Returns an awaitable yielding the next batch of records ( co_await stream.next_batch() )
+         *
+         * @return batch_awaiter
+         */
+        batch_awaiter next_batch() {
+            current_position = current.size();
+            return batch_awaiter(*this);
+        }
+
+    private:
+        record_batch* take_batch() {
+            std::unique_lock<std::mutex> lck(batches_resx);
+            if (ready_batches.empty()) {
+                if (read_error) { std::rethrow_exception(read_error); }
+                return nullptr;
+            }
+            if (!current.empty()) { free_batches.push_back(std::move(current)); }
+            current = std::move(ready_batches.front());
+            ready_batches.pop_front();
+            current_position = 0;
+            lck.unlock();
+            batches_changed.notify_all();
+            return &current;
+        }
+
+        void read_batches() {
+            while (true) {
+                record_batch batch;
+                {
+                    std::unique_lock<std::mutex> lck(batches_resx);
+                    batches_changed.wait(lck, [this]() {return stop_reading || ready_batches.size() < options.prefetch_batches;});
+                    if (stop_reading) { return; }
+                    if (!free_batches.empty()) {
+                        batch = std::move(free_batches.back());
+                        free_batches.pop_back();
+                    }
+                }
+
+                // The file is read and parsed without holding the lock
+                std::size_t count = 0;
+                std::exception_ptr error;
+                try {
+                    for (; count < options.batch_size; count++) {
+                        if (count == batch.size()) { batch.emplace_back(); }
+                        if (!next_record(batch[count])) { break; }
+                    }
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+                batch.resize(count);
+                bool last_batch = error || count != options.batch_size;
+
+                std::coroutine_handle<> handle;
+                {
+                    std::lock_guard<std::mutex> lck(batches_resx);
+                    if (count != 0) { ready_batches.push_back(std::move(batch)); }
+                    reached_end = last_batch;
+                    read_error = error;
+                    handle = std::exchange(waiting, nullptr);
+                }
+                if (handle) { resume(handle); }
+                if (last_batch) { return; }
+            }
+        }
+    };
+
+
+    /**
+     * @brief Returns a stream of the remaining records of a reader for coroutines. The file is read and parsed ahead
+     * on a background thread, co_await on the stream suspends the coroutine until the next batch is parsed instead of
+     * blocking on the file. The reader must outlive the stream and must not be used while the stream exists
+     *
+     * @param csv_reader reader whose remaining records are streamed
+     * @param resume callable void(std::coroutine_handle<>) posting a suspended coroutine back to its event loop
+     * @param options batch size and the number of batches read ahead
+     * @return std::unique_ptr<async_record_stream<Dialect>> stream of records ( co_await stream->next() )
+     */
+    template<template<class,class>class Parser,class FileReader,class Dialect>
+    std::unique_ptr<async_record_stream<Dialect>> async_records(basic_reader<Parser,FileReader,Dialect>& csv_reader,
+        typename async_record_stream<Dialect>::resume_function resume, const async_options& options = {}) {
+        return std::make_unique<async_record_stream<Dialect>>(
+            [&csv_reader](basic_record<Dialect>& record) {return csv_reader.next(record);}, std::move(resume), options);
+    }
+
+}
+
+#endif
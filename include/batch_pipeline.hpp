@@ -0,0 +1,131 @@
+#ifndef BATCH_PIPELINE_HPP
+#define BATCH_PIPELINE_HPP
+
+#include<mutex>
+#include<thread>
+#include<vector>
+#include<algorithm>
+#include<utility>
+#include<type_traits>
+#include<exception>
+#include<record.hpp>
+#include<concurrent_queue.hpp>
+#include<thread_placement.hpp>
+
+namespace turbo_csv {
+
+    /**
+     * @brief Parameters of a parallel pass over records
+     *
+     * thread_count        : number of worker threads
+     * batch_size          : number of records handed to a worker at once
+     * max_pending_batches : parsed batches waiting for a worker after which parsing blocks ( 0 for 2*thread_count )
+     */
+    struct parallel_options {
+        std::size_t thread_count = std::thread::hardware_concurrency();
+        std::size_t batch_size = 1024;
+        std::size_t max_pending_batches = 0;
+    };
+
+    /**
+     * @brief Parses records on the calling thread and hands them out in batches to worker threads.
+     * Batches are dealt round robin into per worker queues, a worker whose queue runs dry steals from the
+     * others. Batches are recycled once processed so that the record buffers are reused
+     *
+     * @tparam Dialect dialect of the records
+     * @param next_record callable bool(basic_record<Dialect>&) refilling the record with the next row
+     * @param options number of threads, batch size and backpressure
+     * @param process_batch callable void(std::size_t worker_index, std::vector<basic_record<Dialect>>& batch) or
+     * void(std::size_t worker_index, std::size_t first_record, std::vector<basic_record<Dialect>>& batch) where
+     * first_record is the index of the first record of the batch ( for keeping results in record order )
+     * @throw Rethrows the first exception thrown by next_record or process_batch
+     */
+    template<typename Dialect, typename NextRecord, typename ProcessBatch>
+    void process_batches(NextRecord&& next_record, const parallel_options& options, ProcessBatch&& process_batch) {
+        using record_batch = std::vector<basic_record<Dialect>>;
+        // Batch along with the index of its first record
+        using numbered_batch = std::pair<std::size_t, record_batch>;
+
+        auto thread_count = std::max<std::size_t>(options.thread_count, 1);
+        auto batch_size = std::max<std::size_t>(options.batch_size, 1);
+        auto max_pending_batches = options.max_pending_batches == 0 ? 2 * thread_count : options.max_pending_batches;
+
+        // Filled batches are bounded so that the producer cannot run away from the workers
+        work_stealing_queues<numbered_batch> filled_batches(thread_count, max_pending_batches);
+        bounded_queue<record_batch> free_batches(max_pending_batches + thread_count + 1);
+
+        std::mutex error_resx;
+        std::exception_ptr error;
+        auto fail = [&]() {
+            std::lock_guard<std::mutex> lck(error_resx);
+            if (!error) { error = std::current_exception(); }
+            filled_batches.close();
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(thread_count);
+        for (std::size_t worker_index = 0; worker_index < thread_count; worker_index++) {
+            workers.emplace_back([&, worker_index]() {
+                placement::place_worker(worker_index);
+                try {
+                    while (auto batch = filled_batches.pop(worker_index)) {
+                        auto& [first_record, records] = batch.value();
+                        if constexpr (std::is_invocable_v<ProcessBatch&, std::size_t, std::size_t, record_batch&>) {
+                            process_batch(worker_index, first_record, records);
+                        }
+                        else {
+                            process_batch(worker_index, records);
+                        }
+                        free_batches.try_push(records);
+                    }
+                }
+                catch (...) {
+                    fail();
+                }
+            });
+        }
+
+        try {
+            std::size_t next_first_record = 0;
+            for (std::size_t batch_index = 0;; batch_index++) {
+                auto batch = free_batches.try_pop().value_or(record_batch{});
+                std::size_t count = 0;
+                for (; count < batch_size; count++) {
+                    if (count == batch.size()) { batch.emplace_back(); }
+                    if (!next_record(batch[count])) { break; }
+                }
+                batch.resize(count);
+
+                if (count != 0 && !filled_batches.push(batch_index, numbered_batch(next_first_record, std::move(batch)))) { break; }
+                next_first_record += count;
+                if (count != batch_size) { break; }
+            }
+        }
+        catch (...) {
+            fail();
+        }
+
+        filled_batches.close();
+        for (auto& worker : workers) { worker.join(); }
+
+        if (error) { std::rethrow_exception(error); }
+    }
+
+    /**
+     * @brief Parses records on the calling thread and hands them out in batches to worker threads
+     *
+     * @param thread_count number of worker threads
+     * @param batch_size number of records handed to a worker at once
+     * @see process_batches(NextRecord&&, const parallel_options&, ProcessBatch&&)
+     */
+    template<typename Dialect, typename NextRecord, typename ProcessBatch>
+    void process_batches(NextRecord&& next_record, std::size_t thread_count, std::size_t batch_size, ProcessBatch&& process_batch) {
+        parallel_options options;
+        options.thread_count = thread_count;
+        options.batch_size = batch_size;
+        process_batches<Dialect>(std::forward<NextRecord>(next_record), options, std::forward<ProcessBatch>(process_batch));
+    }
+
+}
+
+#endif
@@ -0,0 +1,223 @@
+#ifndef CONCURRENT_QUEUE_HPP
+#define CONCURRENT_QUEUE_HPP
+
+#include<deque>
+#include<mutex>
+#include<memory>
+#include<vector>
+#include<optional>
+#include<condition_variable>
+
+namespace turbo_csv {
+    template<typename T>
+    class bounded_queue {
+        std::deque<T> items;
+        std::size_t capacity;
+        bool closed = false;
+
+        std::mutex items_resx;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+
+    public:
+
+        /**
+         * @brief Construct a new bounded queue object
+         *
+         * @param capacity number of items after which push blocks (backpressure)
+         */
+        bounded_queue(std::size_t capacity) :capacity(capacity == 0 ? 1 : capacity) {}
+
+        /**
+         * @brief Pushes an item. Blocks while the queue is full
+         *
+         * @param item item to be pushed
+         * @return true item was pushed
+         * @return false queue was closed, item is dropped
+         */
+        bool push(T item) {
+            std::unique_lock<std::mutex> lck(items_resx);
+            not_full.wait(lck, [this]() {return closed || items.size() < capacity;});
+            if (closed) { return false; }
+            items.push_back(std::move(item));
+            lck.unlock();
+            not_empty.notify_one();
+            return true;
+        }
+
+        /**
+         * @brief Pushes an item only if there is space left in the queue
+         *
+         * @param item item to be pushed
+         * @return true item was pushed
+         * @return false queue is full or closed
+         */
+        bool try_push(T& item) {
+            {
+                std::lock_guard<std::mutex> lck(items_resx);
+                if (closed || items.size() >= capacity) { return false; }
+                items.push_back(std::move(item));
+            }
+            not_empty.notify_one();
+            return true;
+        }
+
+        /**
+         * @brief Pops an item. Blocks until an item is available or the queue is closed
+         *
+         * @return std::optional<T> popped item/nullopt if queue is closed and drained
+         */
+        std::optional<T> pop() {
+            std::unique_lock<std::mutex> lck(items_resx);
+            not_empty.wait(lck, [this]() {return closed || !items.empty();});
+            if (items.empty()) { return {}; }
+            T item = std::move(items.front());
+            items.pop_front();
+            lck.unlock();
+            not_full.notify_one();
+            return item;
+        }
+
+        /**
+         * @brief Pops an item if one is available without blocking
+         *
+         * @return std::optional<T> popped item/nullopt if queue is empty
+         */
+        std::optional<T> try_pop() {
+            std::unique_lock<std::mutex> lck(items_resx);
+            if (items.empty()) { return {}; }
+            T item = std::move(items.front());
+            items.pop_front();
+            lck.unlock();
+            not_full.notify_one();
+            return item;
+        }
+
+        /**
+         * @brief Closes the queue. Pending items can still be popped, pushes fail from now on
+         *
+         */
+        void close() {
+            {
+                std::lock_guard<std::mutex> lck(items_resx);
+                closed = true;
+            }
+            not_empty.notify_all();
+            not_full.notify_all();
+        }
+
+    };
+
+    /**
+     * @brief One queue per worker, workers pop from their own queue and steal from the others once it is
+     * empty so that uneven items do not leave threads idle. The number of queued items is bounded (backpressure)
+     *
+     */
+    template<typename T>
+    class work_stealing_queues {
+        struct worker_queue {
+            std::mutex items_resx;
+            std::deque<T> items;
+        };
+
+        std::vector<std::unique_ptr<worker_queue>> queues;
+        std::size_t capacity;
+
+        // Items reserved by push ( pending ) and items sitting in the queues ( queued )
+        std::size_t pending = 0;
+        std::size_t queued = 0;
+        bool closed = false;
+
+        std::mutex state_resx;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+
+    public:
+
+        /**
+         * @brief Construct new work stealing queues
+         *
+         * @param worker_count number of workers ( and queues )
+         * @param capacity number of queued items after which push blocks (backpressure)
+         */
+        work_stealing_queues(std::size_t worker_count, std::size_t capacity) :capacity(capacity == 0 ? 1 : capacity) {
+            for (std::size_t worker = 0; worker < (worker_count == 0 ? 1 : worker_count); worker++) {
+                queues.push_back(std::make_unique<worker_queue>());
+            }
+        }
+
+        /**
+         * @brief Pushes an item into the queue of a worker. Blocks while the queues are full
+         *
+         * @param worker_index worker whose queue receives the item
+         * @param item item to be pushed
+         * @return true item was pushed
+         * @return false queues were closed, item is dropped
+         */
+        bool push(std::size_t worker_index, T item) {
+            {
+                std::unique_lock<std::mutex> lck(state_resx);
+                not_full.wait(lck, [this]() {return closed || pending < capacity;});
+                if (closed) { return false; }
+                pending++;
+            }
+            {
+                auto& queue = *queues[worker_index % queues.size()];
+                std::lock_guard<std::mutex> queue_lck(queue.items_resx);
+                queue.items.push_back(std::move(item));
+                std::lock_guard<std::mutex> lck(state_resx);
+                queued++;
+            }
+            not_empty.notify_one();
+            return true;
+        }
+
+        /**
+         * @brief Pops the oldest item of the worker's queue or steals the newest item of another queue.
+         * Blocks until an item is available or the queues are closed
+         *
+         * @param worker_index worker popping the item
+         * @return std::optional<T> popped item/nullopt if queues are closed and drained
+         */
+        std::optional<T> pop(std::size_t worker_index) {
+            while (true) {
+                for (std::size_t i = 0; i < queues.size(); i++) {
+                    if (auto item = take(*queues[(worker_index + i) % queues.size()], i == 0)) {
+                        not_full.notify_one();
+                        return item;
+                    }
+                }
+                std::unique_lock<std::mutex> lck(state_resx);
+                not_empty.wait(lck, [this]() {return queued != 0 || (closed && pending == 0);});
+                if (queued == 0) { return {}; }
+            }
+        }
+
+        /**
+         * @brief Closes the queues. Queued items can still be popped, pushes fail from now on
+         *
+         */
+        void close() {
+            {
+                std::lock_guard<std::mutex> lck(state_resx);
+                closed = true;
+            }
+            not_empty.notify_all();
+            not_full.notify_all();
+        }
+
+    private:
+        std::optional<T> take(worker_queue& queue, bool own) {
+            std::lock_guard<std::mutex> queue_lck(queue.items_resx);
+            if (queue.items.empty()) { return {}; }
+            T item = std::move(own ? queue.items.front() : queue.items.back());
+            own ? queue.items.pop_front() : queue.items.pop_back();
+            std::lock_guard<std::mutex> lck(state_resx);
+            queued--;
+            pending--;
+            return item;
+        }
+    };
+}
+
+#endif
@@ -6,14 +6,20 @@
 #include<cstring>
 #include<filesystem>
 #include<optional>
+#include<string_view>
 #include<mutex>
 #include<thread>
 #include<algorithm>
 #include<atomic>
+#include<exception>
+#include<condition_variable>
+#include<pipeline_stats.hpp>
+#include<utf8_validator.hpp>
+#include<thread_placement.hpp>
 
 
 namespace turbo_csv {
-    template<std::uint64_t buffer_size = 1024>
+    template<std::uint64_t buffer_size = 1024, bool Stats = false>
     class file_reader {
 
         std::thread producer_thread;
@@ -24,44 +30,61 @@ namespace turbo_csv {
         char ibuf1[buffer_size];
         char ibuf2[buffer_size];
 
-        std::mutex ibuf1_resx;
-        std::mutex ibuf2_resx;
+        // consumed    : buffer can be filled by the producer
+        // filled      : buffer holds ibuf_size bytes for the consumer
+        // end_of_file : no more data is left in the file
+        enum class buffer_state { consumed, filled, end_of_file };
 
-        std::size_t current_read_count = 0;
+        // Guarded by buffers_resx
+        buffer_state ibuf_state[2] = { buffer_state::consumed, buffer_state::consumed };
+        std::size_t ibuf_size[2] = { 0, 0 };
+        bool stop_producer = false;
+        std::exception_ptr producer_error;
 
-        std::atomic_bool ibuf1_consumed = false;
-        std::atomic_bool ibuf2_consumed = false;
+        std::mutex buffers_resx;
+        std::condition_variable buffers_changed;
 
-        char current_active = 'A';
-        char* buf_ptr;
-        std::atomic_bool stop_producer = false;
+        std::size_t current_read_count = 0;
+
+        int current_active = 0;
+        bool holding_buffer = false;
+        bool reached_end = false;
+        char* buf_ptr = nullptr;
+        char* buf_end = nullptr;
+
+        // Producer side: offset of the next byte read from the file and the optional validation stage
+        std::uint64_t fill_offset = 0;
+        std::optional<utf8_validator> utf8;
+
+        // Producer side counters are read by the consumer, consumer side ones only by the consumer
+        [[no_unique_address]] basic_shared_stats_counter<Stats> bytes_read;
+        [[no_unique_address]] basic_shared_stats_counter<Stats> refill_count;
+        [[no_unique_address]] basic_shared_stats_counter<Stats> producer_fill_ns;
+        [[no_unique_address]] basic_stats_counter<Stats> consumer_wait_ns;
     public:
+        // Whether the counters above are collected ( see collects_stats )
+        static constexpr bool stats_enabled = Stats;
+
         /**
          * @brief Construct a new file reader object
          *
          * @param path_to_file An absolute or relative path that points to the location of file
          * @throw std::fstream::faliure If an irrecoverable stream error occured or I/O operation failed
          */
-        file_reader(const std::string& path_to_file) noexcept(false) :file_path(path_to_file), buf_ptr(ibuf1) {
+        file_reader(const std::string& path_to_file) noexcept(false) :file_path(path_to_file) {
             //Ensure that exceptions are thrown  if the file fails to open
             file.exceptions(std::fstream::failbit | std::fstream::badbit);
             file.open(path_to_file,std::ios::binary|std::ios::in);
 
-            //Initialize both the buffers with data for the first time and lock ibuf1 for use by get_byte
-            initialize();
-            ibuf1_resx.lock();
-
-            // Call populate buffer on seperate thread that fills the buffer when it gets consumed
-            std::thread populator([this] () {this->populate_buffer();});
-
-            // Transfer ownership to the producer_thred(class object)
-            producer_thread = std::move(populator);
+            // Short reads at the end of file set failbit, only irrecoverable errors should throw from now on
+            file.exceptions(std::fstream::badbit);
 
+            // Fill the buffers on seperate thread that refills a buffer as soon as it gets consumed
+            start_producer();
         }
 
         ~file_reader() {
-            stop_producer.store(true);
-            producer_thread.join();
+            stop_producer_thread();
         }
         /**
          * @brief Checks if the file is open for reading or not
@@ -95,83 +118,173 @@ namespace turbo_csv {
          * @brief Get the byte at the current location in the file
          *
          * @return std::optional<std::uint8_t> Current byte pointed inside the file/nullopt if reading completed
+         * @throw std::fstream::failure If reading from the file failed
          */
         std::optional<std::uint8_t> get_byte() {
-            if (*buf_ptr != '$' && *buf_ptr != '#') {
-                current_read_count++;
-                return *buf_ptr++;
+            if (buf_ptr == buf_end && !switch_buffer()) {
+                return {};
             }
+            current_read_count++;
+            return static_cast<std::uint8_t>(*buf_ptr++);
+        }
 
-            if (*buf_ptr == '#') {
-                ibuf1_resx.unlock();
-                ibuf2_resx.unlock();
+        /**
+         * @brief Returns the bytes left in the current buffer ( the next buffer is waited for if it is consumed )
+         *
+         * @return std::string_view view into the buffer, empty if reading completed. Valid until skip_buffered
+         * consumes it completely or get_byte is called
+         * @throw std::fstream::failure If reading from the file failed
+         */
+        std::string_view get_buffered() {
+            if (buf_ptr == buf_end && !switch_buffer()) {
                 return {};
             }
+            return std::string_view(buf_ptr, static_cast<std::size_t>(buf_end - buf_ptr));
+        }
 
-            if (current_active == 'A' && *buf_ptr == '$') {
-                switch_buffer('B');
-                current_read_count++;
-                return *buf_ptr++;
-            }
-            else {
-                switch_buffer('A');
-                current_read_count++;
-                return *buf_ptr++;
-            }
+        /**
+         * @brief Consumes bytes returned by get_buffered
+         *
+         * @param count number of bytes consumed ( at most the size of the view returned by get_buffered )
+         */
+        void skip_buffered(std::size_t count) noexcept {
+            buf_ptr += count;
+            current_read_count += count;
+        }
+
+        /**
+         * @brief Adds the file reading statistics to the snapshot ( all zero unless Stats is set )
+         *
+         * @param stats snapshot to be filled
+         */
+        void collect_stats(pipeline_stats& stats) {
+            stats.bytes_read = bytes_read.get();
+            stats.refill_count = refill_count.get();
+            stats.producer_fill_ns = producer_fill_ns.get();
+            stats.consumer_wait_ns = consumer_wait_ns.get();
+        }
+
+        /**
+         * @brief Enables utf-8 validation of the buffers from the current position onwards. Buffers are validated
+         * by the producer thread right after being filled, so validation overlaps with parsing
+         *
+         * @param options what to do with invalid sequences ( see utf8_options )
+         */
+        void set_utf8_options(utf8_options options) {
+            static_assert(buffer_size >= 4, "utf-8 validation needs buffers that can hold a complete sequence");
+            stop_producer_thread();
+            utf8.emplace(std::move(options));
+            // Bytes already buffered are read again so that they get validated as well
+            seek(current_read_count);
+        }
+
+        /**
+         * @brief Returns the byte offset of the first invalid utf-8 sequence found so far
+         *
+         * @return std::optional<std::uint64_t> offset/nullopt if no invalid sequence was found ( or validation is disabled )
+         */
+        std::optional<std::uint64_t> get_first_invalid_utf8_offset() {
+            if (!utf8) { return {}; }
+            return utf8->first_invalid_offset();
+        }
 
+        /**
+         * @brief Returns the number of invalid utf-8 sequences found so far
+         *
+         * @return std::uint64_t
+         */
+        std::uint64_t get_invalid_utf8_count() {
+            return utf8 ? utf8->invalid_sequences() : 0;
+        }
+
+        /**
+         * @brief Moves the reading position to the given byte offset in the file
+         *
+         * @param offset byte offset from the beginning of the file
+         */
+        void seek(std::uint64_t offset) {
+            stop_producer_thread();
+
+            file.clear();
+            file.seekg(static_cast<std::streamoff>(offset));
+            fill_offset = offset;
+            if (utf8) { utf8->reset(); }
+
+            ibuf_state[0] = ibuf_state[1] = buffer_state::consumed;
+            producer_error = nullptr;
+            stop_producer = false;
+            current_active = 0;
+            holding_buffer = false;
+            reached_end = false;
+            buf_ptr = buf_end = nullptr;
+            current_read_count = offset;
+
+            start_producer();
         }
 
     private:
-    
-        void switch_buffer(char new_active) {
-
-            switch (new_active) {
-
-                case 'A':
-                    ibuf2_consumed = true;
-                    ibuf2_resx.unlock();
-                    while (ibuf1_consumed);
-                    buf_ptr = ibuf1;
-                    ibuf1_resx.lock();
-                    break;
-
-                case 'B':
-                    ibuf1_consumed = true;
-                    ibuf1_resx.unlock();
-                    while (ibuf2_consumed);
-                    buf_ptr = ibuf2;
-                    ibuf2_resx.lock();
-                    break;
 
+        char* buffer(int index) {
+            return index == 0 ? ibuf1 : ibuf2;
+        }
+
+        bool switch_buffer() {
+            if (reached_end) { return false; }
+
+            std::unique_lock<std::mutex> lck(buffers_resx);
+
+            // Hand the consumed buffer back to the producer and move on to the other one
+            if (holding_buffer) {
+                ibuf_state[current_active] = buffer_state::consumed;
+                current_active ^= 1;
+                buffers_changed.notify_all();
+            }
+            {
+                basic_stats_timer<basic_stats_counter<Stats>, Stats> wait_timer(consumer_wait_ns);
+                buffers_changed.wait(lck, [this]() {return ibuf_state[current_active] != buffer_state::consumed;});
+            }
+            holding_buffer = true;
+
+            if (ibuf_state[current_active] == buffer_state::end_of_file) {
+                reached_end = true;
+                if (producer_error) { std::rethrow_exception(producer_error); }
+                return false;
             }
-            current_active = new_active;
+
+            buf_ptr = buffer(current_active);
+            buf_end = buf_ptr + ibuf_size[current_active];
+            return true;
         }
+
         void populate_buffer() {
+            int next = 0;
             while (true) {
-                if (stop_producer.load()) {
-                    return;
+                {
+                    std::unique_lock<std::mutex> lck(buffers_resx);
+                    buffers_changed.wait(lck, [this, next]() {return stop_producer || ibuf_state[next] == buffer_state::consumed;});
+                    if (stop_producer) { return; }
                 }
-                if (ibuf1_consumed) {
-                    std::lock_guard<std::mutex>lck(ibuf1_resx);
-                    auto buf_state = fill_buffer(ibuf1);
-                    if (!buf_state) {
-                        std::fill(ibuf1, ibuf1 + 1, '#');
-                        ibuf1_consumed = false;
-                        return;
-                    }
-                    ibuf1_consumed = false;
+
+                // Consumer does not touch a consumed buffer so it is filled without holding the lock
+                std::size_t filled_bytes = 0;
+                std::exception_ptr error;
+                try {
+                    filled_bytes = fill_buffer(buffer(next));
                 }
-                else if (ibuf2_consumed) {
-                    std::lock_guard<std::mutex>lck(ibuf2_resx);
-                    auto buf_state = fill_buffer(ibuf2);
-                    if (!buf_state) {
-                        std::fill(ibuf2, ibuf2 + 1, '#');
-                        ibuf2_consumed = false;
-                        return;
-                    }
-                    ibuf2_consumed = false;
+                catch (...) {
+                    error = std::current_exception();
                 }
 
+                {
+                    std::lock_guard<std::mutex> lck(buffers_resx);
+                    ibuf_size[next] = filled_bytes;
+                    ibuf_state[next] = filled_bytes == 0 ? buffer_state::end_of_file : buffer_state::filled;
+                    producer_error = error;
+                }
+                buffers_changed.notify_all();
+
+                if (filled_bytes == 0) { return; }
+                next ^= 1;
             }
 
         }
@@ -179,37 +292,58 @@ namespace turbo_csv {
 
 
         /**
-         * @brief Fills the buffer with data from file
+         * @brief Fills the buffer with data from file ( validated if utf-8 validation is enabled )
          *
          * @param buf Buffer to be filled
-         * @return true If the data was filled successfully into buffer
-         * @return false If No data is left to be read
+         * @return std::size_t Number of bytes filled (0 if no data is left to be read)
          */
-        bool fill_buffer(char* buf)noexcept {
+        std::size_t fill_buffer(char* buf) {
+            basic_stats_timer<basic_shared_stats_counter<Stats>, Stats> fill_timer(producer_fill_ns);
+
+            // A utf-8 sequence split at the end of the previous buffer is moved to the beginning of this one
+            std::size_t carried = utf8 ? utf8->restore_carry(buf) : 0;
+            file.read(buf + carried, static_cast<std::streamsize>(buffer_size - carried));
+            auto read_bytes = static_cast<std::size_t>(file.gcount());
+            bytes_read.add(read_bytes);
+            refill_count.add(read_bytes != 0);
+
+            auto buffer_offset = fill_offset - carried;
+            fill_offset += read_bytes;
+            auto filled_bytes = carried + read_bytes;
+            if (utf8) {
+                filled_bytes = utf8->process(buf, filled_bytes, buffer_offset, read_bytes < buffer_size - carried);
+            }
+            return filled_bytes;
+        }
 
-            auto remaining_bytes = get_filesize() - file.tellg();
+        void start_producer() {
+            // Call populate buffer on seperate thread that fills the buffer when it gets consumed. It is placed next
+            // to the consumer ( if enabled ) so that the bytes it reads are still in a cache the consumer shares
+            std::thread populator([this, producer_placement = placement::helper_placement()] () {
+                producer_placement.apply();
+                this->populate_buffer();
+            });
 
-            if (remaining_bytes == 0) { return false; } // Nothing left to fill buf
+            // Transfer ownership to the producer_thred(class object)
+            producer_thread = std::move(populator);
+        }
 
-            if (remaining_bytes <= buffer_size - 1) {
-                file.read(buf, remaining_bytes);
-                buf[remaining_bytes] = '#';
+        void stop_producer_thread() {
+            {
+                std::lock_guard<std::mutex> lck(buffers_resx);
+                stop_producer = true;
             }
-            else {
-                file.read(buf, buffer_size - 1);
-                buf[buffer_size - 1] = '$';
+            buffers_changed.notify_all();
+            if (producer_thread.joinable()) {
+                producer_thread.join();
             }
-
-            return true;
-
-        }
-        void initialize()noexcept {
-            fill_buffer(ibuf1);
-            fill_buffer(ibuf2);
         }
 
     };
 
+    template<std::uint64_t buffer_size = 1024>
+    using stats_file_reader = file_reader<buffer_size, true>;
+
 }
 
 
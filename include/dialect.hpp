@@ -2,7 +2,9 @@
 #define DIALECT_HPP
 
 #include<vector>
+#include<cstring>
 #include<algorithm>
+#include<string_view>
 
 namespace turbo_csv {
     class dialect {
@@ -42,6 +44,152 @@ namespace turbo_csv {
         }
 
     };
+
+    /**
+     * @brief Compile time string usable as a template argument ( eg. delimited_dialect<"||"> )
+     *
+     */
+    template<std::size_t N>
+    struct fixed_string {
+        char value[N]{};
+
+        constexpr fixed_string(const char(&characters)[N]) {
+            std::copy_n(characters, N, value);
+        }
+
+        constexpr std::size_t size() const { return N - 1; }
+        constexpr std::string_view view() const { return { value, N - 1 }; }
+    };
+
+    /**
+     * @brief Dialect with (possibly) multi byte field/record seperators and an optional quote escape character
+     * eg. delimited_dialect<"||"> or delimited_dialect<"\x1f","\x1e"> or delimited_dialect<",","\n",'"','\\'>
+     *
+     * @tparam FieldSeperator bytes seperating the fields
+     * @tparam RecordSeperator bytes seperating the records
+     * @tparam EscapeCharacter character enclosing (quoting) fields
+     * @tparam QuoteEscape character making the next character literal ('\0' if quotes are escaped by doubling them)
+     */
+    template<fixed_string FieldSeperator, fixed_string RecordSeperator = "\n", char EscapeCharacter = '\"', char QuoteEscape = '\0'>
+    class delimited_dialect {
+        static_assert(FieldSeperator.size() != 0 && RecordSeperator.size() != 0, "seperators can not be empty");
+        inline static std::vector<char> ignore_characters = {};
+    public:
+
+        static auto get_recordseperator() {
+            return RecordSeperator.value[0];
+        }
+        static auto get_fieldseperator() {
+            return FieldSeperator.value[0];
+        }
+        static const auto& get_ignore_characters() {
+            return ignore_characters;
+        }
+        static auto get_escapecharacter() {
+            return EscapeCharacter;
+        }
+
+        static std::string_view get_recordseperator_sequence() requires (RecordSeperator.size() > 1) {
+            return RecordSeperator.view();
+        }
+        static std::string_view get_fieldseperator_sequence() requires (FieldSeperator.size() > 1) {
+            return FieldSeperator.view();
+        }
+        static char get_quoteescape() requires (QuoteEscape != '\0') {
+            return QuoteEscape;
+        }
+
+        // For multi byte seperators these match the first byte, the rest is matched through dialect_traits
+        static auto is_recordseperator(char character) {
+            return character == RecordSeperator.value[0];
+        }
+        static auto is_fieldseperator(char character) {
+            return character == FieldSeperator.value[0];
+        }
+        static auto is_ignorecharacter(char) {
+            return false;
+        }
+        static auto is_escapecharacter(char character) {
+            return character == EscapeCharacter;
+        }
+    };
+
+    /**
+     * @brief Optional parts of the Dialect concept. A dialect may additionally provide
+     *
+     * get_fieldseperator_sequence()  : std::string_view of a multi byte field seperator ( is_fieldseperator
+     *                                  then matches its first byte )
+     * get_recordseperator_sequence() : std::string_view of a multi byte record seperator ( is_recordseperator
+     *                                  then matches its first byte )
+     * get_quoteescape()              : character making the next character literal ( eg. backslash escaped
+     *                                  quotes ). Quotes are escaped by doubling them otherwise
+     *
+     * Dialects providing none of them take the single byte paths, which are left untouched
+     */
+    template<typename Dialect>
+    struct dialect_traits {
+        static constexpr bool multibyte_fieldseperator = requires { Dialect::get_fieldseperator_sequence(); };
+        static constexpr bool multibyte_recordseperator = requires { Dialect::get_recordseperator_sequence(); };
+        static constexpr bool has_quoteescape = requires { Dialect::get_quoteescape(); };
+        static constexpr bool single_byte = !multibyte_fieldseperator && !multibyte_recordseperator && !has_quoteescape;
+
+        static std::size_t fieldseperator_size() {
+            if constexpr (multibyte_fieldseperator) { return Dialect::get_fieldseperator_sequence().size(); }
+            else { return 1; }
+        }
+
+        static std::size_t recordseperator_size() {
+            if constexpr (multibyte_recordseperator) { return Dialect::get_recordseperator_sequence().size(); }
+            else { return 1; }
+        }
+
+        static bool is_quoteescape(char character) {
+            if constexpr (has_quoteescape) { return character == Dialect::get_quoteescape(); }
+            else { return false; }
+        }
+
+        /**
+         * @brief Checks whether a field seperator begins at position
+         *
+         */
+        static bool fieldseperator_at(std::string_view data, std::size_t position) {
+            if constexpr (multibyte_fieldseperator) { return matches_at(data, position, Dialect::get_fieldseperator_sequence()); }
+            else { return position < data.size() && Dialect::is_fieldseperator(data[position]); }
+        }
+
+        /**
+         * @brief Checks whether a field seperator ends right before position
+         *
+         */
+        static bool fieldseperator_before(std::string_view data, std::size_t position) {
+            auto size = fieldseperator_size();
+            return position >= size && fieldseperator_at(data, position - size);
+        }
+
+        /**
+         * @brief Checks whether a record seperator begins at position
+         *
+         */
+        static bool recordseperator_at(std::string_view data, std::size_t position) {
+            if constexpr (multibyte_recordseperator) { return matches_at(data, position, Dialect::get_recordseperator_sequence()); }
+            else { return position < data.size() && Dialect::is_recordseperator(data[position]); }
+        }
+
+        /**
+         * @brief Checks whether data ends with a (complete) record seperator
+         *
+         */
+        static bool ends_with_recordseperator(std::string_view data) {
+            auto size = recordseperator_size();
+            return data.size() >= size && recordseperator_at(data, data.size() - size);
+        }
+
+    private:
+        static bool matches_at(std::string_view data, std::size_t position, std::string_view sequence) {
+            return position <= data.size() && data.size() - position >= sequence.size() &&
+                std::memcmp(data.data() + position, sequence.data(), sequence.size()) == 0;
+        }
+    };
 }
 
 #endif
\ No newline at end of file
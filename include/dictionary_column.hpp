@@ -0,0 +1,248 @@
+#ifndef DICTIONARY_COLUMN_HPP
+#define DICTIONARY_COLUMN_HPP
+
+#include<mutex>
+#include<limits>
+#include<string>
+#include<thread>
+#include<vector>
+#include<cstdint>
+#include<optional>
+#include<algorithm>
+#include<stdexcept>
+#include<functional>
+#include<string_view>
+#include<unordered_map>
+#include<turbo_csv.hpp>
+#include<field_utils.hpp>
+#include<batch_pipeline.hpp>
+
+namespace turbo_csv {
+
+    /**
+     * @brief Dictionary built by a single thread. Every distinct value is stored once in an arena and
+     * encoded as a local code ( order of first appearance )
+     *
+     */
+    class dictionary_builder {
+        string_arena arena;
+        std::unordered_map<std::string_view, std::int32_t, string_hash, std::equal_to<>> codes;
+        std::vector<std::string_view> values;
+
+    public:
+        /**
+         * @brief Returns the local code of a value, adding it to the dictionary if it is new
+         *
+         * @param value value to be encoded
+         * @return std::int32_t local code of the value
+         * @throw std::length_error if the dictionary grows past INT32_MAX values
+         */
+        std::int32_t encode(std::string_view value) {
+            auto entry = codes.find(value);
+            if (entry != codes.end()) { return entry->second; }
+            if (values.size() == static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+                throw std::length_error("turbo_csv::dictionary_builder: too many distinct values");
+            }
+            auto stored = arena.store(value);
+            auto code = static_cast<std::int32_t>(values.size());
+            values.push_back(stored);
+            codes.emplace(stored, code);
+            return code;
+        }
+
+        /**
+         * @brief Returns the values in the order of their local codes
+         *
+         * @return const std::vector<std::string_view>& values
+         */
+        const std::vector<std::string_view>& get_values() const {
+            return values;
+        }
+    };
+
+    /**
+     * @brief Consecutive rows encoded by one dictionary_builder
+     *
+     * first_row : index of the first row of the chunk
+     * builder   : index of the builder whose local codes are used ( null_code for null rows )
+     */
+    struct dictionary_chunk {
+        std::size_t first_row = 0;
+        std::size_t builder = 0;
+        std::vector<std::int32_t> codes;
+    };
+
+    /**
+     * @brief Dictionary encoded column : every distinct value is stored once and every row holds the 32 bit code
+     * of its value. Values are sorted, so codes compare the same way as the values ( in byte order )
+     *
+     */
+    class dictionary_column {
+        std::vector<std::string> values;
+        std::vector<std::int32_t> codes;
+
+    public:
+        // Code of null rows : the column is missing or empty ( after trimming spaces and quotes ), the same fields
+        // profile_columns counts as null
+        static constexpr std::int32_t null_code = -1;
+
+        dictionary_column() = default;
+
+        /**
+         * @brief Merges the dictionaries of several threads into one column
+         *
+         * @param builders dictionaries built by the threads
+         * @param chunks runs of consecutive rows encoded with the local codes of one of the builders
+         */
+        dictionary_column(const std::vector<dictionary_builder>& builders, const std::vector<dictionary_chunk>& chunks) {
+            for (const auto& builder : builders) {
+                values.insert(values.end(), builder.get_values().begin(), builder.get_values().end());
+            }
+            std::sort(values.begin(), values.end());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+
+            // Local code to code of the merged dictionary, for every builder
+            std::vector<std::vector<std::int32_t>> remapped(builders.size());
+            for (std::size_t builder = 0; builder < builders.size(); builder++) {
+                remapped[builder].reserve(builders[builder].get_values().size());
+                for (auto value : builders[builder].get_values()) {
+                    remapped[builder].push_back(find_code(value).value());
+                }
+            }
+
+            std::size_t row_count = 0;
+            for (const auto& chunk : chunks) { row_count = std::max(row_count, chunk.first_row + chunk.codes.size()); }
+            codes.assign(row_count, null_code);
+            for (const auto& chunk : chunks) {
+                const auto& chunk_remapped = remapped[chunk.builder];
+                for (std::size_t row = 0; row < chunk.codes.size(); row++) {
+                    auto code = chunk.codes[row];
+                    codes[chunk.first_row + row] = code == null_code ? null_code : chunk_remapped[static_cast<std::size_t>(code)];
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the number of rows
+         *
+         * @return std::size_t
+         */
+        std::size_t size() const noexcept {
+            return codes.size();
+        }
+
+        /**
+         * @brief Returns the value of a row
+         *
+         * @param row index of the row
+         * @return std::string_view value ( empty for null rows )
+         */
+        std::string_view operator[](std::size_t row) const {
+            auto code = codes[row];
+            return code == null_code ? std::string_view() : std::string_view(values[static_cast<std::size_t>(code)]);
+        }
+
+        bool is_null(std::size_t row) const {
+            return codes[row] == null_code;
+        }
+
+        /**
+         * @brief Returns the code of every row ( null_code for null rows )
+         *
+         * @return const std::vector<std::int32_t>& codes in row order
+         */
+        const std::vector<std::int32_t>& get_codes() const noexcept {
+            return codes;
+        }
+
+        /**
+         * @brief Returns the distinct values, value i has code i
+         *
+         * @return const std::vector<std::string>& sorted distinct values
+         */
+        const std::vector<std::string>& get_values() const noexcept {
+            return values;
+        }
+
+        /**
+         * @brief Returns the code of a value
+         *
+         * @param value value to look for
+         * @return std::optional<std::int32_t> code/nullopt if no row holds the value
+         */
+        std::optional<std::int32_t> find_code(std::string_view value) const {
+            auto position = std::lower_bound(values.begin(), values.end(), value,
+                [](const std::string& lhs, std::string_view rhs) { return std::string_view(lhs) < rhs; });
+            if (position == values.end() || *position != value) { return {}; }
+            return static_cast<std::int32_t>(position - values.begin());
+        }
+
+        /**
+         * @brief Counts the rows holding every value ( a group by on the column without touching the values )
+         *
+         * @return std::vector<std::size_t> number of rows of every code
+         */
+        std::vector<std::size_t> value_counts() const {
+            std::vector<std::size_t> counts(values.size(), 0);
+            for (auto code : codes) {
+                if (code != null_code) { counts[static_cast<std::size_t>(code)]++; }
+            }
+            return counts;
+        }
+
+        /**
+         * @brief Returns the number of bytes held by the column
+         *
+         * @return std::size_t
+         */
+        std::size_t memory_size() const noexcept {
+            std::size_t bytes = codes.capacity() * sizeof(std::int32_t) + values.capacity() * sizeof(std::string);
+            for (const auto& value : values) {
+                if (value.capacity() > sizeof(std::string) - 2) { bytes += value.capacity() + 1; }
+            }
+            return bytes;
+        }
+    };
+
+    /**
+     * @brief Dictionary encodes a column of the remaining records of the reader. Records are not retained, every
+     * thread encodes the batches it is handed with its own dictionary and the dictionaries are merged at the end,
+     * so only the distinct values and one 32 bit code per row are kept in memory
+     *
+     * @param csv_reader reader whose remaining records are encoded
+     * @param column_index column to be encoded ( fields are trimmed of spaces and quotes, empty ones are null )
+     * @param thread_count number of encoding threads
+     * @param batch_size number of records handed to a thread at once
+     * @return dictionary_column codes of the remaining records in file order
+     * @throw std::length_error If the column has more than INT32_MAX distinct values
+     */
+    template<template<class,class>class Parser,class FileReader,class Dialect>
+    dictionary_column get_dictionary_column(basic_reader<Parser,FileReader,Dialect>& csv_reader, std::size_t column_index,
+        std::size_t thread_count = std::thread::hardware_concurrency(), std::size_t batch_size = 1024) {
+
+        thread_count = std::max<std::size_t>(thread_count, 1);
+        std::vector<dictionary_builder> builders(thread_count);
+        std::vector<dictionary_chunk> chunks;
+        std::mutex chunks_resx;
+
+        auto encode_batch = [&](std::size_t worker_index, std::size_t first_record, std::vector<basic_record<Dialect>>& batch) {
+            auto& builder = builders[worker_index];
+            dictionary_chunk chunk{ first_record, worker_index, {} };
+            chunk.codes.reserve(batch.size());
+            for (auto& record : batch) {
+                auto& fields = record.get_fields();
+                auto field = column_index < fields.size() ? trim_field(fields[column_index], Dialect::get_escapecharacter()) : std::string_view();
+                chunk.codes.push_back(field.empty() ? dictionary_column::null_code : builder.encode(field));
+            }
+            std::lock_guard<std::mutex> lck(chunks_resx);
+            chunks.push_back(std::move(chunk));
+        };
+
+        process_batches<Dialect>([&csv_reader](basic_record<Dialect>& record) {return csv_reader.next(record);},
+            thread_count, batch_size, encode_batch);
+        return dictionary_column(builders, chunks);
+    }
+
+}
+
+#endif
@@ -0,0 +1,303 @@
+#ifndef EXTERNAL_SORT_HPP
+#define EXTERNAL_SORT_HPP
+
+#include<cmath>
+#include<cstdio>
+#include<cstring>
+#include<queue>
+#include<future>
+#include<atomic>
+#include<thread>
+#include<vector>
+#include<filesystem>
+#include<algorithm>
+#include<turbo_csv.hpp>
+#include<turbo_writer.hpp>
+#include<field_utils.hpp>
+#include<thread_placement.hpp>
+
+namespace turbo_csv {
+
+    /**
+     * @brief Options of the external sort
+     *
+     * memory_budget                : approximate number of bytes of records held in memory at once ( while merging,
+     *                                the readers of the merged runs and their buffers count against it )
+     * temp_directory               : directory in which the sorted runs are spilled
+     * thread_count                 : number of threads sorting a chunk
+     * max_merge_width              : maximum number of runs merged at once (more runs are merged in passes), it is
+     *                                lowered further so that the readers of the merged runs fit in the memory budget
+     * treat_first_record_as_header : first record is written first and not sorted
+     * numeric                      : compare keys as numbers ( fields that are not numbers are placed last )
+     */
+    struct sort_options {
+        std::size_t memory_budget = std::size_t(256) << 20;
+        std::filesystem::path temp_directory = std::filesystem::temp_directory_path();
+        std::size_t thread_count = std::thread::hardware_concurrency();
+        std::size_t max_merge_width = 64;
+        bool treat_first_record_as_header = false;
+        bool numeric = false;
+    };
+
+    template<template<class,class>class Parser,class FileReader,class Dialect>
+    class basic_sorter {
+        std::size_t key_column;
+        sort_options options;
+
+        // Key of a record along with an 8 byte order preserving prefix of it. Most of the comparisons
+        // are decided by the prefix alone
+        struct sort_key {
+            std::uint64_t prefix;
+            std::string_view key;
+            std::size_t record_index;
+        };
+
+        using record_chunk = std::vector<basic_record<Dialect>>;
+
+        static constexpr std::uint64_t non_numeric_prefix = ~std::uint64_t(0);
+
+        std::vector<std::filesystem::path> spilled_runs;
+        inline static std::atomic<std::size_t> run_counter = 0;
+
+    public:
+
+        /**
+         * @brief Construct a new sorter object
+         *
+         * @param key_column index of the column to sort by
+         * @param options options of the sort
+         */
+        basic_sorter(std::size_t key_column, sort_options options = {}) :key_column(key_column), options(std::move(options)) {
+            this->options.thread_count = std::max<std::size_t>(this->options.thread_count, 1);
+            this->options.max_merge_width = std::max<std::size_t>(this->options.max_merge_width, 2);
+        }
+
+        basic_sorter(const basic_sorter&) = delete;
+        basic_sorter& operator=(const basic_sorter&) = delete;
+
+        ~basic_sorter() {
+            remove_runs(spilled_runs);
+        }
+
+        /**
+         * @brief Sorts the records of input by the key column and writes them to output. Chunks that fit in the
+         * memory budget are sorted and spilled as runs into the temp directory, which are then k-way merged
+         *
+         * @param input path of the csv file to be sorted
+         * @param output path of the sorted csv file
+         */
+        void sort(const std::string& input, const std::string& output) {
+            basic_reader<Parser,FileReader,Dialect> csv_reader(input);
+            basic_record<Dialect> header;
+            if (options.treat_first_record_as_header) {
+                csv_reader.next(header);
+            }
+
+            // Half of the budget is used for the chunk being read, the other half by the chunk being
+            // sorted and spilled in background
+            auto chunk_budget = std::max<std::size_t>(options.memory_budget / 2, 1);
+
+            record_chunk chunk;
+            std::future<void> pending_spill;
+            bool input_exhausted = false;
+
+            while (!input_exhausted) {
+                input_exhausted = !read_chunk(csv_reader, chunk, chunk_budget);
+
+                // Everything fits in memory. No need to spill anything
+                if (input_exhausted && spilled_runs.empty() && !pending_spill.valid()) {
+                    basic_writer<Dialect> csv_writer(output);
+                    if (!header.is_empty()) { csv_writer.write(header); }
+                    for (auto& key : sort_chunk(chunk)) {
+                        csv_writer.write(chunk[key.record_index]);
+                    }
+                    return;
+                }
+
+                if (pending_spill.valid()) { pending_spill.get(); }
+                if (chunk.empty()) { break; }
+
+                auto run = next_run_path();
+                spilled_runs.push_back(run);
+                pending_spill = std::async(std::launch::async, [this, run, sorted_chunk = std::move(chunk),
+                    spill_placement = placement::helper_placement()]() mutable {
+                    spill_placement.apply();
+                    basic_writer<Dialect> run_writer(run.string());
+                    for (auto& key : sort_chunk(sorted_chunk)) {
+                        run_writer.write(sorted_chunk[key.record_index]);
+                    }
+                });
+                chunk = record_chunk{};
+            }
+            if (pending_spill.valid()) { pending_spill.get(); }
+
+            // Merge in passes until the remaining runs can be merged at once into the output
+            auto merge_width = get_merge_width();
+            while (spilled_runs.size() > merge_width) {
+                std::vector<std::filesystem::path> merged_runs;
+                for (std::size_t first = 0; first < spilled_runs.size(); first += merge_width) {
+                    auto last = std::min(first + merge_width, spilled_runs.size());
+                    std::vector<std::filesystem::path> runs(spilled_runs.begin() + first, spilled_runs.begin() + last);
+                    auto merged_run = next_run_path();
+                    merged_runs.push_back(merged_run);
+                    merge_runs(runs, merged_run.string(), nullptr);
+                    remove_runs(runs);
+                }
+                spilled_runs = std::move(merged_runs);
+            }
+
+            merge_runs(spilled_runs, output, header.is_empty() ? nullptr : &header);
+            remove_runs(spilled_runs);
+            spilled_runs.clear();
+        }
+
+    private:
+
+        bool read_chunk(basic_reader<Parser,FileReader,Dialect>& csv_reader, record_chunk& chunk, std::size_t budget) {
+            std::size_t chunk_bytes = 0;
+            while (chunk_bytes < budget) {
+                chunk.emplace_back();
+                if (!csv_reader.next(chunk.back())) {
+                    chunk.pop_back();
+                    return false;
+                }
+                // Raw data, field views and the sort key of the record
+                chunk_bytes += sizeof(basic_record<Dialect>) + sizeof(sort_key) +
+                    chunk.back().get_raw_size() + chunk.back().get_field_count() * sizeof(std::string_view);
+            }
+            return true;
+        }
+
+        std::vector<sort_key> sort_chunk(record_chunk& chunk) {
+            std::vector<sort_key> keys(chunk.size());
+            for (std::size_t i = 0; i < chunk.size(); i++) {
+                keys[i].key = key_of(chunk[i]);
+                keys[i].prefix = prefix_of(keys[i].key);
+                keys[i].record_index = i;
+            }
+
+            // Ties are broken by position so that the sort is stable
+            auto compare = [this](const sort_key& lhs, const sort_key& rhs) {
+                if (less(lhs, rhs)) { return true; }
+                return !less(rhs, lhs) && lhs.record_index < rhs.record_index;
+            };
+
+            // Sort equal parts in parallel and merge them pairwise
+            auto parts = std::min<std::size_t>(options.thread_count, std::max<std::size_t>(keys.size() / 4096, 1));
+            std::vector<std::size_t> bounds;
+            for (std::size_t part = 0; part <= parts; part++) {
+                bounds.push_back(keys.size() * part / parts);
+            }
+
+            std::vector<std::future<void>> sorted_parts;
+            for (std::size_t part = 0; part < parts; part++) {
+                sorted_parts.push_back(std::async(std::launch::async, [&, part]() {
+                    placement::place_worker(part);
+                    std::sort(keys.begin() + bounds[part], keys.begin() + bounds[part + 1], compare);
+                }));
+            }
+            for (auto& sorted_part : sorted_parts) { sorted_part.get(); }
+
+            for (std::size_t width = 1; width < parts; width *= 2) {
+                for (std::size_t part = 0; part + width < parts; part += 2 * width) {
+                    auto last = std::min(part + 2 * width, parts);
+                    std::inplace_merge(keys.begin() + bounds[part], keys.begin() + bounds[part + width], keys.begin() + bounds[last], compare);
+                }
+            }
+            return keys;
+        }
+
+        // Every run merged at once holds a reader ( including the buffers of its file reader ) and a record, the
+        // fan in is capped so that they fit in the memory budget
+        std::size_t get_merge_width() const {
+            auto run_bytes = sizeof(basic_reader<Parser,FileReader,Dialect>) + sizeof(basic_record<Dialect>) + BUFSIZ;
+            return std::clamp<std::size_t>(options.memory_budget / run_bytes, 2, options.max_merge_width);
+        }
+
+        void merge_runs(const std::vector<std::filesystem::path>& runs, const std::string& output, basic_record<Dialect>* header) {
+            struct run_cursor {
+                std::unique_ptr<basic_reader<Parser,FileReader,Dialect>> csv_reader;
+                basic_record<Dialect> record;
+                sort_key key;
+            };
+
+            std::vector<run_cursor> cursors(runs.size());
+            auto advance = [this](run_cursor& cursor) {
+                if (!cursor.csv_reader->next(cursor.record)) { return false; }
+                cursor.key.key = key_of(cursor.record);
+                cursor.key.prefix = prefix_of(cursor.key.key);
+                return true;
+            };
+
+            // Priority queue of run indices, the run holding the smallest key is on top
+            auto greater = [&](std::size_t lhs, std::size_t rhs) {
+                if (less(cursors[rhs].key, cursors[lhs].key)) { return true; }
+                if (less(cursors[lhs].key, cursors[rhs].key)) { return false; }
+                return lhs > rhs; // Keeps the merge stable
+            };
+            std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(greater)> heads(greater);
+
+            for (std::size_t run = 0; run < runs.size(); run++) {
+                cursors[run].csv_reader = std::make_unique<basic_reader<Parser,FileReader,Dialect>>(runs[run].string());
+                if (advance(cursors[run])) { heads.push(run); }
+            }
+
+            basic_writer<Dialect> csv_writer(output);
+            if (header != nullptr) { csv_writer.write(*header); }
+            while (!heads.empty()) {
+                auto run = heads.top();
+                heads.pop();
+                csv_writer.write(cursors[run].record);
+                if (advance(cursors[run])) { heads.push(run); }
+            }
+        }
+
+        std::string_view key_of(basic_record<Dialect>& record) {
+            auto& fields = record.get_fields();
+            if (key_column >= fields.size()) { return {}; }
+            return trim_field(fields[key_column], Dialect::get_escapecharacter());
+        }
+
+        std::uint64_t prefix_of(std::string_view key) {
+            if (options.numeric) {
+                double value;
+                if (!parse_number(key, value) || std::isnan(value)) { return non_numeric_prefix; }
+                // Order preserving mapping of the IEEE 754 representation onto unsigned integers
+                value += 0.0;
+                std::uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return (bits & (std::uint64_t(1) << 63)) ? ~bits : bits | (std::uint64_t(1) << 63);
+            }
+            // First 8 bytes in big endian order compare the same way as the strings
+            std::uint64_t prefix = 0;
+            for (std::size_t i = 0; i < 8; i++) {
+                prefix <<= 8;
+                if (i < key.size()) { prefix |= static_cast<unsigned char>(key[i]); }
+            }
+            return prefix;
+        }
+
+        bool less(const sort_key& lhs, const sort_key& rhs) const {
+            if (lhs.prefix != rhs.prefix) { return lhs.prefix < rhs.prefix; }
+            if (options.numeric && lhs.prefix != non_numeric_prefix) { return false; }
+            return lhs.key < rhs.key;
+        }
+
+        std::filesystem::path next_run_path() {
+            auto name = "turbo_csv_sort_" + std::to_string(reinterpret_cast<std::uintptr_t>(this)) + "_" + std::to_string(run_counter++) + ".csv";
+            return options.temp_directory / name;
+        }
+
+        static void remove_runs(const std::vector<std::filesystem::path>& runs) {
+            for (auto& run : runs) {
+                std::error_code ignored;
+                std::filesystem::remove(run, ignored);
+            }
+        }
+
+    };
+
+    using sorter = basic_sorter<parser,adapted_fstream,dialect>;
+}
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef FIELD_UTILS_HPP
+#define FIELD_UTILS_HPP
+
+#include<cerrno>
+#include<cstdlib>
+#include<cctype>
+#include<cstring>
+#include<string>
+#include<memory>
+#include<vector>
+#include<algorithm>
+#include<charconv>
+#include<functional>
+#include<string_view>
+
+namespace turbo_csv {
+
+    /**
+     * @brief Transparent hash so that hash tables keyed by std::string can be looked up with the
+     * std::string_view of a field without constructing a std::string
+     *
+     */
+    struct string_hash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view value) const noexcept {
+            return std::hash<std::string_view>{}(value);
+        }
+        std::size_t operator()(const std::string& value) const noexcept {
+            return std::hash<std::string_view>{}(value);
+        }
+        std::size_t operator()(const char* value) const noexcept {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    /**
+     * @brief Removes the leading and trailing spaces as well as the enclosing escape characters of a field
+     *
+     * @param field view into the field
+     * @param escape_character escape character of the dialect
+     * @return std::string_view trimmed view
+     */
+    inline std::string_view trim_field(std::string_view field, char escape_character = '\"') noexcept {
+        while (!field.empty() && field.front() == ' ') { field.remove_prefix(1); }
+        while (!field.empty() && field.back() == ' ') { field.remove_suffix(1); }
+        if (field.size() >= 2 && field.front() == escape_character && field.back() == escape_character) {
+            field.remove_prefix(1);
+            field.remove_suffix(1);
+        }
+        return field;
+    }
+
+    /**
+     * @brief Parses a number from a field without throwing
+     *
+     * @tparam T arithmetic type to parse into
+     * @param field view into the field ( spaces and enclosing quotes are trimmed )
+     * @param value parsed value
+     * @return true field contained a valid number
+     * @return false field is empty or not a number (value is left untouched)
+     */
+    template<typename T>
+    inline bool parse_number(std::string_view field, T& value, char escape_character = '\"') noexcept {
+        field = trim_field(field, escape_character);
+        if (!field.empty() && field.front() == '+') { field.remove_prefix(1); }
+        if (field.empty()) { return false; }
+#ifndef __cpp_lib_to_chars
+        // Floating point std::from_chars is missing before libstdc++ 11, strtod is used on a null terminated copy
+        // rejecting what from_chars rejects ( leading spaces or signs, hexadecimal )
+        if constexpr (std::is_floating_point_v<T>) {
+            char copy[128];
+            if (field.size() >= sizeof(copy) || field.front() == '+' || std::isspace(static_cast<unsigned char>(field.front())) ||
+                field.find_first_of("xX") != std::string_view::npos) {
+                return false;
+            }
+            std::memcpy(copy, field.data(), field.size());
+            copy[field.size()] = '\0';
+            char* end = nullptr;
+            errno = 0;
+            T parsed;
+            if constexpr (std::is_same_v<T, float>) { parsed = std::strtof(copy, &end); }
+            else if constexpr (std::is_same_v<T, double>) { parsed = std::strtod(copy, &end); }
+            else { parsed = std::strtold(copy, &end); }
+            if (errno == ERANGE || end != copy + field.size()) { return false; }
+            value = parsed;
+            return true;
+        }
+        else
+#endif
+        {
+            auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+            return result.ec == std::errc() && result.ptr == field.data() + field.size();
+        }
+    }
+
+    /**
+     * @brief Append only storage for strings ( eg. hash table keys ). Strings are copied into large blocks so that
+     * storing one does not allocate, views into the arena stay valid until it is cleared or destroyed
+     *
+     */
+    class string_arena {
+        std::vector<std::unique_ptr<char[]>> blocks;
+        std::size_t block_size;
+        std::size_t used = 0;
+        std::size_t capacity = 0;
+        std::size_t allocated = 0;
+
+    public:
+        string_arena(std::size_t block_size = 1 << 16) :block_size(block_size) {}
+
+        /**
+         * @brief Copies a string into the arena
+         *
+         * @param value string to be stored
+         * @return std::string_view view of the stored copy
+         */
+        std::string_view store(std::string_view value) {
+            if (value.size() > capacity - used) {
+                // Strings larger than a block get a block of their own
+                capacity = std::max(block_size, value.size());
+                blocks.push_back(std::make_unique<char[]>(capacity));
+                allocated += capacity;
+                used = 0;
+            }
+            char* stored = blocks.back().get() + used;
+            std::copy(value.begin(), value.end(), stored);
+            used += value.size();
+            return std::string_view(stored, value.size());
+        }
+
+        /**
+         * @brief Returns the number of bytes allocated by the arena
+         *
+         * @return std::size_t allocated bytes
+         */
+        std::size_t memory_size() const noexcept {
+            return allocated;
+        }
+
+        void clear() noexcept {
+            blocks.clear();
+            used = capacity = allocated = 0;
+        }
+    };
+
+}
+
+#endif
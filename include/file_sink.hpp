@@ -0,0 +1,351 @@
+#ifndef FILE_SINK_HPP
+#define FILE_SINK_HPP
+
+#include<fstream>
+#include<string>
+#include<vector>
+#include<thread>
+#include<mutex>
+#include<exception>
+#include<condition_variable>
+#include<thread_placement.hpp>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include<cstring>
+#include<system_error>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/syscall.h>
+#include<linux/io_uring.h>
+#define TURBO_CSV_HAS_IO_URING 1
+#endif
+
+namespace turbo_csv {
+
+    /**
+     * @brief Sink that writes blocks synchronously to a file
+     *
+     */
+    class file_sink {
+        std::ofstream file;
+
+    public:
+        /**
+         * @brief Construct a new file sink object (truncates the file if it exists)
+         *
+         * @param path_to_file path of the file to be written
+         * @throw std::fstream::failure If the file could not be opened for writing
+         */
+        file_sink(const std::string& path_to_file) noexcept(false) {
+            file.exceptions(std::fstream::failbit | std::fstream::badbit);
+            file.open(path_to_file, std::ios::binary | std::ios::out | std::ios::trunc);
+        }
+
+        /**
+         * @brief Writes a block of data to the file
+         *
+         * @param data beginning of the block
+         * @param size size of block in bytes
+         */
+        void write(const char* data, std::size_t size) {
+            file.write(data, static_cast<std::streamsize>(size));
+        }
+
+        /**
+         * @brief Flushes the data written till now to the file
+         *
+         */
+        void flush() {
+            file.flush();
+        }
+    };
+
+    /**
+     * @brief Sink that hands over blocks to a background thread which writes them to the file.
+     * The caller only waits if the previous block is still being written
+     *
+     */
+    class async_file_sink {
+        file_sink file;
+
+        std::vector<char> pending_block;
+        bool has_pending_block = false;
+        bool stop_flusher = false;
+        std::exception_ptr error;
+
+        std::mutex block_resx;
+        std::condition_variable block_state;
+
+        std::thread flusher_thread;
+
+    public:
+        /**
+         * @brief Construct a new async file sink object
+         *
+         * @param path_to_file path of the file to be written
+         * @throw std::fstream::failure If the file could not be opened for writing
+         */
+        async_file_sink(const std::string& path_to_file) noexcept(false) :file(path_to_file) {
+            flusher_thread = std::thread([this, flusher_placement = placement::helper_placement()]() {
+                flusher_placement.apply();
+                this->write_blocks();
+            });
+        }
+
+        async_file_sink(const async_file_sink&) = delete;
+        async_file_sink& operator=(const async_file_sink&) = delete;
+
+        ~async_file_sink() {
+            {
+                std::unique_lock<std::mutex> lck(block_resx);
+                block_state.wait(lck, [this]() {return !has_pending_block;});
+                stop_flusher = true;
+            }
+            block_state.notify_all();
+            flusher_thread.join();
+        }
+
+        /**
+         * @brief Copies the block and queues it for writing
+         *
+         * @param data beginning of the block
+         * @param size size of block in bytes
+         * @throw std::fstream::failure If writing a previous block failed
+         */
+        void write(const char* data, std::size_t size) {
+            std::unique_lock<std::mutex> lck(block_resx);
+            block_state.wait(lck, [this]() {return !has_pending_block;});
+            rethrow_error();
+            pending_block.assign(data, data + size);
+            has_pending_block = true;
+            lck.unlock();
+            block_state.notify_all();
+        }
+
+        /**
+         * @brief Waits for the queued block to be written and flushes the file
+         *
+         * @throw std::fstream::failure If writing a block failed
+         */
+        void flush() {
+            std::unique_lock<std::mutex> lck(block_resx);
+            block_state.wait(lck, [this]() {return !has_pending_block;});
+            rethrow_error();
+            file.flush();
+        }
+
+    private:
+
+        void write_blocks() {
+            std::unique_lock<std::mutex> lck(block_resx);
+            while (true) {
+                block_state.wait(lck, [this]() {return stop_flusher || has_pending_block;});
+                if (!has_pending_block) { return; }
+
+                // Block is not touched by the producer until has_pending_block is cleared
+                lck.unlock();
+                try {
+                    file.write(pending_block.data(), pending_block.size());
+                }
+                catch (...) {
+                    lck.lock();
+                    error = std::current_exception();
+                    lck.unlock();
+                }
+                lck.lock();
+                has_pending_block = false;
+                block_state.notify_all();
+            }
+        }
+
+        void rethrow_error() {
+            if (error) {
+                auto pending_error = error;
+                error = nullptr;
+                std::rethrow_exception(pending_error);
+            }
+        }
+    };
+
+#ifdef TURBO_CSV_HAS_IO_URING
+
+    /**
+     * @brief Sink that submits the blocks to the kernel through io_uring. While a block is in flight
+     * the next one is being filled by the writer
+     *
+     */
+    class uring_file_sink {
+        int file_descriptor = -1;
+        int ring_descriptor = -1;
+
+        void* sq_ring = MAP_FAILED;
+        void* cq_ring = MAP_FAILED;
+        io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+        std::size_t sq_ring_size = 0;
+        std::size_t cq_ring_size = 0;
+        std::size_t sqes_size = 0;
+
+        unsigned* sq_tail;
+        unsigned* sq_mask;
+        unsigned* sq_array;
+        unsigned* cq_head;
+        unsigned* cq_tail;
+        unsigned* cq_mask;
+        io_uring_cqe* cqes;
+
+        std::vector<char> blocks[2];
+        int active_block = 0;
+        bool in_flight = false;
+        std::uint64_t file_offset = 0;
+
+    public:
+        /**
+         * @brief Construct a new uring file sink object (truncates the file if it exists)
+         *
+         * @param path_to_file path of the file to be written
+         * @throw std::system_error If the file could not be opened or io_uring is not available
+         */
+        uring_file_sink(const std::string& path_to_file) noexcept(false) {
+            file_descriptor = ::open(path_to_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (file_descriptor < 0) {
+                throw std::system_error(errno, std::generic_category(), "turbo_csv::uring_file_sink: open");
+            }
+            try {
+                setup_ring();
+            }
+            catch (...) {
+                release();
+                throw;
+            }
+        }
+
+        uring_file_sink(const uring_file_sink&) = delete;
+        uring_file_sink& operator=(const uring_file_sink&) = delete;
+
+        ~uring_file_sink() {
+            try { wait_for_completion(); }
+            catch (...) {}
+            release();
+        }
+
+        /**
+         * @brief Copies the block and submits it. Waits for the previously submitted block first
+         *
+         * @param data beginning of the block
+         * @param size size of block in bytes
+         * @throw std::system_error If writing the previous block failed
+         */
+        void write(const char* data, std::size_t size) {
+            auto& block = blocks[active_block];
+            block.assign(data, data + size);
+            wait_for_completion();
+
+            auto tail = *sq_tail;
+            auto index = tail & *sq_mask;
+            io_uring_sqe& sqe = sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_WRITE;
+            sqe.fd = file_descriptor;
+            sqe.addr = reinterpret_cast<std::uint64_t>(block.data());
+            sqe.len = static_cast<std::uint32_t>(block.size());
+            sqe.off = file_offset;
+            sq_array[index] = index;
+            __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+            if (enter(1, 0, 0) < 0) {
+                throw std::system_error(errno, std::generic_category(), "turbo_csv::uring_file_sink: submit");
+            }
+            in_flight = true;
+            active_block ^= 1;
+        }
+
+        /**
+         * @brief Waits for the block in flight to be written
+         *
+         * @throw std::system_error If writing the block failed
+         */
+        void flush() {
+            wait_for_completion();
+        }
+
+    private:
+
+        int enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+            return static_cast<int>(::syscall(__NR_io_uring_enter, ring_descriptor, to_submit, min_complete, flags, nullptr, 0));
+        }
+
+        void setup_ring() {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            ring_descriptor = static_cast<int>(::syscall(__NR_io_uring_setup, 2, &params));
+            if (ring_descriptor < 0) {
+                throw std::system_error(errno, std::generic_category(), "turbo_csv::uring_file_sink: io_uring_setup");
+            }
+
+            sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+            sq_ring = ::mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_descriptor, IORING_OFF_SQ_RING);
+            cq_ring = ::mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_descriptor, IORING_OFF_CQ_RING);
+            sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_descriptor, IORING_OFF_SQES));
+            if (sq_ring == MAP_FAILED || cq_ring == MAP_FAILED || sqes == MAP_FAILED) {
+                throw std::system_error(errno, std::generic_category(), "turbo_csv::uring_file_sink: mmap");
+            }
+
+            auto sq_base = static_cast<char*>(sq_ring);
+            auto cq_base = static_cast<char*>(cq_ring);
+            sq_tail = reinterpret_cast<unsigned*>(sq_base + params.sq_off.tail);
+            sq_mask = reinterpret_cast<unsigned*>(sq_base + params.sq_off.ring_mask);
+            sq_array = reinterpret_cast<unsigned*>(sq_base + params.sq_off.array);
+            cq_head = reinterpret_cast<unsigned*>(cq_base + params.cq_off.head);
+            cq_tail = reinterpret_cast<unsigned*>(cq_base + params.cq_off.tail);
+            cq_mask = reinterpret_cast<unsigned*>(cq_base + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq_base + params.cq_off.cqes);
+        }
+
+        void wait_for_completion() {
+            if (!in_flight) { return; }
+            in_flight = false;
+
+            auto head = *cq_head;
+            while (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+                if (enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+                    throw std::system_error(errno, std::generic_category(), "turbo_csv::uring_file_sink: wait");
+                }
+            }
+            auto result = cqes[head & *cq_mask].res;
+            __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+
+            if (result < 0) {
+                throw std::system_error(-result, std::generic_category(), "turbo_csv::uring_file_sink: write");
+            }
+
+            // Block in flight is the one that is not active. Short writes are finished synchronously
+            auto& block = blocks[active_block ^ 1];
+            std::size_t written = static_cast<std::size_t>(result);
+            while (written < block.size()) {
+                auto count = ::pwrite(file_descriptor, block.data() + written, block.size() - written, file_offset + written);
+                if (count < 0) {
+                    throw std::system_error(errno, std::generic_category(), "turbo_csv::uring_file_sink: write");
+                }
+                written += static_cast<std::size_t>(count);
+            }
+            file_offset += block.size();
+        }
+
+        void release() {
+            if (sqes != MAP_FAILED) { ::munmap(sqes, sqes_size); }
+            if (cq_ring != MAP_FAILED) { ::munmap(cq_ring, cq_ring_size); }
+            if (sq_ring != MAP_FAILED) { ::munmap(sq_ring, sq_ring_size); }
+            if (ring_descriptor >= 0) { ::close(ring_descriptor); }
+            if (file_descriptor >= 0) { ::close(file_descriptor); }
+        }
+    };
+
+#endif
+
+}
+
+#endif
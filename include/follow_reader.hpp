@@ -0,0 +1,369 @@
+#ifndef FOLLOW_READER_HPP
+#define FOLLOW_READER_HPP
+
+#include<chrono>
+#include<string>
+#include<vector>
+#include<thread>
+#include<optional>
+#include<filesystem>
+#include<system_error>
+#include<record.hpp>
+#include<turbo_parser.hpp>
+#include<dialect.hpp>
+
+#ifdef __linux__
+#include<fcntl.h>
+#include<poll.h>
+#include<unistd.h>
+#include<sys/stat.h>
+#include<sys/inotify.h>
+#else
+#include<fstream>
+#endif
+
+namespace turbo_csv {
+
+    /**
+     * @brief File reader for files that keep growing (logs). Only complete records are handed out:
+     * bytes after the last record seperator (outside quotes) are held back until the rest of the record
+     * is appended. Rotation (file replaced at the same path) and truncation are detected while polling. Files are
+     * read through their descriptor on linux and through a std::ifstream elsewhere, where a file replaced at
+     * the same path is only noticed once it is shorter than the bytes already read
+     *
+     * @tparam Dialect dialect used to find the record boundaries
+     */
+    template<typename Dialect = dialect>
+    class follow_file_reader {
+        std::filesystem::path file_path;
+#ifdef __linux__
+        int file_descriptor = -1;
+        ino_t file_inode = 0;
+#else
+        std::ifstream file;
+#endif
+        std::uint64_t file_offset = 0;
+
+#ifdef __linux__
+        int inotify_descriptor = -1;
+        int file_watch = -1;
+#endif
+
+        std::vector<char> data;
+        std::size_t read_position = 0;      // next byte handed out
+        std::size_t committed_end = 0;      // end of the last complete record
+        std::size_t scan_position = 0;      // bytes before this are scanned for record boundaries
+        bool in_quotes = false;             // quote state at scan_position
+
+        std::size_t current_read_count = 0;
+
+    public:
+        /**
+         * @brief Construct a new follow file reader object
+         *
+         * @param path_to_file path of the file to be followed
+         * @param start_at_end skip the data already present in the file
+         * @throw std::system_error if the file could not be opened
+         */
+        follow_file_reader(const std::string& path_to_file, bool start_at_end = false) :file_path(path_to_file) {
+            open_file();
+#ifdef __linux__
+            if (start_at_end) {
+                file_offset = static_cast<std::uint64_t>(::lseek(file_descriptor, 0, SEEK_END));
+            }
+            inotify_descriptor = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (inotify_descriptor >= 0) {
+                // The directory is watched as well as rotation creates a new file at the same path
+                auto directory = file_path.has_parent_path() ? file_path.parent_path() : std::filesystem::path(".");
+                watch_file();
+                ::inotify_add_watch(inotify_descriptor, directory.c_str(), IN_CREATE | IN_MOVED_TO);
+            }
+#else
+            if (start_at_end) {
+                file_offset = std::filesystem::file_size(file_path);
+            }
+#endif
+        }
+
+        follow_file_reader(const follow_file_reader&) = delete;
+        follow_file_reader& operator=(const follow_file_reader&) = delete;
+
+        ~follow_file_reader() {
+#ifdef __linux__
+            if (file_descriptor >= 0) { ::close(file_descriptor); }
+            if (inotify_descriptor >= 0) { ::close(inotify_descriptor); }
+#endif
+        }
+
+        /**
+         * @brief Checks if the file is open for reading or not
+         *
+         * @return true File is open for reading
+         */
+        bool is_open() {
+#ifdef __linux__
+            return file_descriptor >= 0;
+#else
+            return file.is_open();
+#endif
+        }
+
+        /**
+         * @brief Gets the current file size in bytes
+         *
+         * @return std::uintmax_t
+         */
+        auto get_filesize() {
+            return std::filesystem::file_size(file_path);
+        }
+
+        /**
+         * @brief Returns the number of characters handed out
+         *
+         * @return std::size_t Number of characters read
+         */
+        auto get_current_readcount() {
+            return current_read_count;
+        }
+
+        /**
+         * @brief Get the next byte of a complete record
+         *
+         * @return std::optional<std::uint8_t> next byte/nullopt if no complete record is available right now
+         */
+        std::optional<std::uint8_t> get_byte() {
+            if (read_position == committed_end) {
+                poll_file();
+                if (read_position == committed_end) { return {}; }
+            }
+            current_read_count++;
+            return static_cast<std::uint8_t>(data[read_position++]);
+        }
+
+        /**
+         * @brief Checks whether a complete record is available without waiting
+         *
+         * @return true at least one complete record can be read
+         */
+        bool has_records() {
+            if (read_position == committed_end) { poll_file(); }
+            return read_position != committed_end;
+        }
+
+        /**
+         * @brief Blocks until the file changes or the timeout expires. Uses inotify on linux and
+         * sleeps for short intervals elsewhere
+         *
+         * @param timeout maximum time to wait
+         * @return true a complete record is available
+         */
+        bool wait_for_data(std::chrono::milliseconds timeout) {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (!has_records()) {
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+                if (remaining.count() <= 0) { return false; }
+#ifdef __linux__
+                if (inotify_descriptor >= 0) {
+                    pollfd watched{ inotify_descriptor, POLLIN, 0 };
+                    // Rotation is also checked periodically in case the event was missed
+                    if (::poll(&watched, 1, static_cast<int>(std::min<std::int64_t>(remaining.count(), 100))) > 0) {
+                        char events[4096];
+                        while (::read(inotify_descriptor, events, sizeof(events)) > 0);
+                    }
+                    continue;
+                }
+#endif
+                std::this_thread::sleep_for(std::min(remaining, std::chrono::milliseconds(10)));
+            }
+            return true;
+        }
+
+    private:
+
+        void open_file() {
+#ifdef __linux__
+            file_descriptor = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (file_descriptor < 0) {
+                throw std::system_error(errno, std::generic_category(), "turbo_csv::follow_file_reader: open " + file_path.string());
+            }
+            struct stat file_stat;
+            ::fstat(file_descriptor, &file_stat);
+            file_inode = file_stat.st_ino;
+#else
+            file.open(file_path, std::ios::binary);
+            if (!file.is_open()) {
+                throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), "turbo_csv::follow_file_reader: open " + file_path.string());
+            }
+#endif
+            file_offset = 0;
+        }
+
+        void watch_file() {
+#ifdef __linux__
+            if (inotify_descriptor < 0) { return; }
+            if (file_watch >= 0) { ::inotify_rm_watch(inotify_descriptor, file_watch); }
+            file_watch = ::inotify_add_watch(inotify_descriptor, file_path.c_str(), IN_MODIFY);
+#endif
+        }
+
+        void poll_file() {
+            compact();
+            if (read_appended() != 0) { return; }
+
+#ifdef __linux__
+            struct stat path_stat;
+            if (::stat(file_path.c_str(), &path_stat) != 0) { return; } // Rotated, new file not created yet
+
+            if (path_stat.st_ino != file_inode) {
+                // Rotated: the old file is complete, its last record does not need a record seperator
+                read_appended();
+                commit_partial_record();
+                ::close(file_descriptor);
+                open_file();
+                watch_file();
+                read_appended();
+            }
+            else if (static_cast<std::uint64_t>(path_stat.st_size) < file_offset) {
+                drop_partial_record();
+                file_offset = 0;
+                read_appended();
+            }
+#else
+            std::error_code error;
+            auto path_size = std::filesystem::file_size(file_path, error);
+            if (error || path_size >= file_offset) { return; } // Rotated and new file not created yet, or unchanged
+
+            // Rotated or truncated, without inodes the stream tells them apart : it still reads the whole old file
+            // if it was rotated
+            file.clear();
+            file.seekg(0, std::ios::end);
+            if (static_cast<std::uint64_t>(file.tellg()) >= file_offset) { commit_partial_record(); }
+            else { drop_partial_record(); }
+            file.close();
+            open_file();
+            read_appended();
+#endif
+        }
+
+        // Truncated in place, the held back partial record will never be completed
+        void drop_partial_record() {
+            data.resize(committed_end);
+            scan_position = committed_end;
+            in_quotes = false;
+        }
+
+        std::size_t read_appended() {
+            std::size_t total = 0;
+            while (true) {
+                auto old_size = data.size();
+                data.resize(old_size + 65536);
+#ifdef __linux__
+                auto count = ::pread(file_descriptor, data.data() + old_size, 65536, static_cast<off_t>(file_offset));
+#else
+                file.clear();
+                file.seekg(static_cast<std::streamoff>(file_offset));
+                file.read(data.data() + old_size, 65536);
+                auto count = file.gcount();
+#endif
+                if (count <= 0) {
+                    data.resize(old_size);
+                    break;
+                }
+                data.resize(old_size + static_cast<std::size_t>(count));
+                file_offset += static_cast<std::uint64_t>(count);
+                total += static_cast<std::size_t>(count);
+            }
+            scan_boundaries();
+            return total;
+        }
+
+        void scan_boundaries() {
+            using traits = dialect_traits<Dialect>;
+            for (; scan_position < data.size(); scan_position++) {
+                auto character = data[scan_position];
+                if (traits::is_quoteescape(character)) {
+                    // Escaped character is not appended yet
+                    if (scan_position + 1 == data.size()) { break; }
+                    scan_position++;
+                }
+                else if (Dialect::is_escapecharacter(character)) {
+                    in_quotes = !in_quotes;
+                }
+                else if (!in_quotes && Dialect::is_recordseperator(character)) {
+                    if constexpr (traits::multibyte_recordseperator) {
+                        // Rest of the seperator is not appended yet
+                        if (data.size() - scan_position < traits::recordseperator_size()) { break; }
+                        if (!traits::recordseperator_at(std::string_view(data.data(), data.size()), scan_position)) { continue; }
+                        scan_position += traits::recordseperator_size() - 1;
+                    }
+                    committed_end = scan_position + 1;
+                }
+            }
+        }
+
+        void commit_partial_record() {
+            if (committed_end != data.size()) {
+                if constexpr (dialect_traits<Dialect>::multibyte_recordseperator) {
+                    auto seperator = Dialect::get_recordseperator_sequence();
+                    data.insert(data.end(), seperator.begin(), seperator.end());
+                }
+                else {
+                    data.push_back(Dialect::get_recordseperator());
+                }
+            }
+            committed_end = scan_position = data.size();
+            in_quotes = false;
+        }
+
+        void compact() {
+            // Drop the bytes that are already handed out once they make up most of the buffer
+            if (read_position != 0 && read_position * 2 >= data.size()) {
+                data.erase(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(read_position));
+                committed_end -= read_position;
+                scan_position -= read_position;
+                read_position = 0;
+            }
+        }
+    };
+
+    template<typename Dialect>
+    class basic_follow_reader {
+        parser<follow_file_reader<Dialect>,Dialect> csv_parser;
+
+    public:
+
+        /**
+         * @brief Construct a new follow reader object
+         *
+         * @param fp path of the growing csv file
+         * @throw std::system_error if the file could not be opened
+         */
+        basic_follow_reader(const std::string& fp) :csv_parser(fp) {}
+
+        /**
+         * @brief Refills the record with the next complete record, waiting for it to be appended if needed
+         *
+         * @param record record to be refilled
+         * @param timeout maximum time to wait for a new record
+         * @return true record contains the next row
+         * @return false no complete record was appended within timeout
+         */
+        bool next(basic_record<Dialect>& record, std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            auto& file_reader = csv_parser.get_file_reader();
+            while (true) {
+                if (csv_parser.next(record)) { return true; }
+                // Empty lines come back as empty records, skip them if more records are available
+                if (file_reader.has_records()) { continue; }
+
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+                if (remaining.count() <= 0 || !file_reader.wait_for_data(remaining)) { return false; }
+            }
+        }
+
+    };
+
+    using follow_reader = basic_follow_reader<dialect>;
+}
+
+#endif
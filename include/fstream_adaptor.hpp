@@ -3,20 +3,28 @@
 #include<string>
 #include<fstream>
 #include<optional>
+#include<pipeline_stats.hpp>
 
 namespace turbo_csv {
-	class adapted_fstream {
+	template<bool Stats = false>
+	class basic_adapted_fstream {
 
 		std::fstream file;
 		std::filesystem::path file_path;
 
+		// Buffering is done by the filebuf, so only the bytes handed out are counted
+		[[no_unique_address]] basic_stats_counter<Stats> bytes_read;
+
 	public:
+		// Whether bytes_read is collected ( see collects_stats )
+		static constexpr bool stats_enabled = Stats;
+
 		/**
 		 * @brief Construct a new adapted fstream object
 		 * 
 		 * @param path_to_file path of the file to be opened
 		 */
-		adapted_fstream(const std::string& path_to_file) :file_path(path_to_file) {
+		basic_adapted_fstream(const std::string& path_to_file) :file_path(path_to_file) {
 			file.open(path_to_file);
 		}
 
@@ -56,9 +64,34 @@ namespace turbo_csv {
 		std::optional<std::uint8_t> get_byte() {
 			auto element = file.get();
 			if (element == EOF) { return {}; }
-			else { return element; }
+			else {
+				bytes_read.add();
+				return element;
+			}
+
+		}
 
+		/**
+		 * @brief Adds the file reading statistics to the snapshot ( all zero unless Stats is set )
+		 * 
+		 * @param stats snapshot to be filled
+		 */
+		void collect_stats(pipeline_stats& stats) {
+			stats.bytes_read = bytes_read.get();
+		}
+
+		/**
+		 * @brief Moves the reading position to the given byte offset in the file
+		 * 
+		 * @param offset byte offset from the beginning of the file
+		 */
+		void seek(std::uint64_t offset) {
+			file.clear();
+			file.seekg(static_cast<std::streamoff>(offset));
 		}
 
 	};
+
+	using adapted_fstream = basic_adapted_fstream<false>;
+	using stats_adapted_fstream = basic_adapted_fstream<true>;
 }
\ No newline at end of file
@@ -0,0 +1,377 @@
+#ifndef HASH_JOIN_HPP
+#define HASH_JOIN_HPP
+
+#include<mutex>
+#include<atomic>
+#include<memory>
+#include<thread>
+#include<vector>
+#include<utility>
+#include<filesystem>
+#include<functional>
+#include<unordered_map>
+#include<turbo_csv.hpp>
+#include<turbo_writer.hpp>
+#include<field_utils.hpp>
+#include<sketches.hpp>
+#include<batch_pipeline.hpp>
+
+namespace turbo_csv {
+
+    /**
+     * @brief inner : only probe records with a matching build record are joined
+     *        left  : probe records without a matching build record are joined with an empty build record
+     */
+    enum class join_kind { inner, left };
+
+    /**
+     * @brief Options of the hash join
+     *
+     * kind                         : inner or left join ( the probe file is the left side )
+     * memory_budget                : approximate number of bytes of build records held in memory. Larger build
+     *                                files are partitioned on disk by the key hash and joined partition by partition,
+     *                                partitions still exceeding it are partitioned again ( records sharing a key
+     *                                are never split, so a single key may still exceed it )
+     * temp_directory               : directory in which the partitions are spilled
+     * partition_count              : number of partitions a spilled join is split into
+     * thread_count                 : number of threads probing the hash table
+     * batch_size                   : number of probe records handed to a thread at once
+     * treat_first_record_as_header : first record of both files is a header ( not joined )
+     */
+    struct join_options {
+        join_kind kind = join_kind::inner;
+        std::size_t memory_budget = std::size_t(256) << 20;
+        std::filesystem::path temp_directory = std::filesystem::temp_directory_path();
+        std::size_t partition_count = 32;
+        std::size_t thread_count = std::thread::hardware_concurrency();
+        std::size_t batch_size = 1024;
+        bool treat_first_record_as_header = false;
+    };
+
+    /**
+     * @brief Streaming hash join of two csv files on a key column. The smaller ( build ) file is loaded into a hash
+     * table whose keys are kept in an arena and looked up by the std::string_view of the probe key, the larger
+     * ( probe ) file is streamed through it by several threads. Keys are compared after trimming spaces and quotes,
+     * records with an empty or missing key never match
+     *
+     */
+    template<template<class,class>class Parser,class FileReader,class Dialect>
+    class basic_joiner {
+        std::size_t probe_key;
+        std::size_t build_key;
+        join_options options;
+
+        // Build records held in memory along with the hash table. Records sharing a key are chained through next_row
+        std::vector<basic_record<Dialect>> build_rows;
+        string_arena keys;
+        std::unordered_map<std::string_view, std::uint32_t, string_hash, std::equal_to<>> table;
+        std::vector<std::uint32_t> next_row;
+        std::size_t build_bytes = 0;
+        std::size_t build_field_count = 0;
+
+        basic_record<Dialect> probe_header;
+        basic_record<Dialect> build_header;
+
+        std::vector<std::filesystem::path> spilled_partitions;
+        inline static std::atomic<std::size_t> partition_counter = 0;
+
+        static constexpr std::uint32_t no_row = ~std::uint32_t(0);
+        static constexpr std::size_t max_partition_level = 4;
+
+        struct partition_set {
+            std::vector<std::filesystem::path> paths;
+            std::vector<std::unique_ptr<basic_writer<Dialect>>> writers;
+        };
+
+    public:
+
+        /**
+         * @brief Construct a new joiner object
+         *
+         * @param probe_key index of the key column in the probe file
+         * @param build_key index of the key column in the build file
+         * @param options options of the join
+         */
+        basic_joiner(std::size_t probe_key, std::size_t build_key, join_options options = {}) :
+            probe_key(probe_key), build_key(build_key), options(std::move(options)) {
+            this->options.thread_count = std::max<std::size_t>(this->options.thread_count, 1);
+            this->options.partition_count = std::max<std::size_t>(this->options.partition_count, 1);
+        }
+
+        basic_joiner(const basic_joiner&) = delete;
+        basic_joiner& operator=(const basic_joiner&) = delete;
+
+        ~basic_joiner() {
+            remove_partitions(spilled_partitions);
+        }
+
+        /**
+         * @brief Joins the records of the probe file with those of the build file. callback is called with every
+         * joined pair from thread_count threads concurrently, in no particular order
+         *
+         * @param probe path of the larger csv file, streamed through the hash table
+         * @param build path of the smaller csv file, loaded into the hash table
+         * @param callback callable void(basic_record<Dialect>& probe_record, basic_record<Dialect>* build_record).
+         * build_record is nullptr for unmatched records of a left join. It is shared by the threads and its
+         * fields are already generated, so it must only be read
+         */
+        template<typename Callback>
+        void join(const std::string& probe, const std::string& build, Callback callback) {
+            run(probe, build,
+                [&callback](std::size_t, basic_record<Dialect>& probe_record, basic_record<Dialect>* build_record) {
+                    callback(probe_record, build_record);
+                },
+                [](std::size_t) {});
+        }
+
+        /**
+         * @brief Joins the records of the probe file with those of the build file and writes every joined record
+         * ( fields of the probe record followed by those of the build record ) to the writer. Headers are joined
+         * the same way if the files have headers
+         *
+         * @param probe path of the larger csv file, streamed through the hash table
+         * @param build path of the smaller csv file, loaded into the hash table
+         * @param csv_writer writer the joined records are written to
+         */
+        void join_into(const std::string& probe, const std::string& build, basic_writer<Dialect>& csv_writer) {
+            // Every thread collects the pairs of a batch and writes them at once
+            std::vector<std::vector<std::pair<basic_record<Dialect>*, basic_record<Dialect>*>>> joined(options.thread_count);
+            std::mutex writer_resx;
+            bool header_written = false;
+
+            auto write_joined = [this, &csv_writer](basic_record<Dialect>& probe_record, basic_record<Dialect>* build_record) {
+                csv_writer.append_fields(probe_record);
+                if (build_record != nullptr) {
+                    csv_writer.append_fields(*build_record);
+                }
+                else {
+                    for (std::size_t field = 0; field < build_field_count; field++) { csv_writer.write_field(std::string_view()); }
+                }
+                csv_writer.end_record();
+            };
+
+            run(probe, build,
+                [&joined](std::size_t worker_index, basic_record<Dialect>& probe_record, basic_record<Dialect>* build_record) {
+                    joined[worker_index].emplace_back(&probe_record, build_record);
+                },
+                [&](std::size_t worker_index) {
+                    std::lock_guard<std::mutex> lck(writer_resx);
+                    if (!header_written && options.treat_first_record_as_header) {
+                        write_joined(probe_header, build_header.is_empty() ? nullptr : &build_header);
+                    }
+                    header_written = true;
+                    for (auto& [probe_record, build_record] : joined[worker_index]) {
+                        write_joined(*probe_record, build_record);
+                    }
+                    joined[worker_index].clear();
+                });
+
+            if (!header_written && options.treat_first_record_as_header && !probe_header.is_empty()) {
+                write_joined(probe_header, build_header.is_empty() ? nullptr : &build_header);
+            }
+        }
+
+    private:
+
+        template<typename Match, typename BatchDone>
+        void run(const std::string& probe, const std::string& build, Match&& match, BatchDone&& batch_done) {
+            clear_table();
+            build_field_count = 0;
+
+            basic_reader<Parser,FileReader,Dialect> build_reader(build);
+            if (options.treat_first_record_as_header) {
+                build_reader.next(build_header);
+                build_field_count = build_header.get_field_count();
+            }
+
+            bool spilled = load_build(build_reader);
+
+            basic_reader<Parser,FileReader,Dialect> probe_reader(probe);
+            if (options.treat_first_record_as_header) {
+                probe_reader.next(probe_header);
+            }
+
+            if (!spilled) {
+                probe_table(probe_reader, match, batch_done);
+                return;
+            }
+
+            // Grace hash join : both files are partitioned by the key hash, matching keys end up in partitions
+            // with the same index which are joined one at a time
+            auto partitions = partition_files(build_reader, probe_reader, 0);
+            for (std::size_t partition = 0; partition < options.partition_count; partition++) {
+                join_partition(partitions.first[partition], partitions.second[partition], 0, match, batch_done);
+            }
+            remove_partitions(spilled_partitions);
+            spilled_partitions.clear();
+        }
+
+        // Joins a build partition with the probe partition of the same index. A build partition exceeding the
+        // memory budget is partitioned again with the seed of the next level, until it fits or its records can no
+        // longer be split ( a single key, or max_partition_level levels deep )
+        template<typename Match, typename BatchDone>
+        void join_partition(const std::filesystem::path& build, const std::filesystem::path& probe, std::size_t level,
+            Match& match, BatchDone& batch_done) {
+            std::pair<std::vector<std::filesystem::path>, std::vector<std::filesystem::path>> partitions;
+            {
+                basic_reader<Parser,FileReader,Dialect> build_reader(build.string());
+                if (load_build(build_reader)) {
+                    if (table.size() > 1 && level < max_partition_level) {
+                        basic_reader<Parser,FileReader,Dialect> probe_reader(probe.string());
+                        partitions = partition_files(build_reader, probe_reader, level + 1);
+                    }
+                    else {
+                        // Records that cannot be split any further are joined even though they exceed the budget
+                        while (load_build(build_reader)) {}
+                    }
+                }
+            }
+
+            if (!partitions.first.empty()) {
+                remove_partitions({ build, probe });
+                for (std::size_t partition = 0; partition < options.partition_count; partition++) {
+                    join_partition(partitions.first[partition], partitions.second[partition], level + 1, match, batch_done);
+                }
+                return;
+            }
+            basic_reader<Parser,FileReader,Dialect> probe_reader(probe.string());
+            probe_table(probe_reader, match, batch_done);
+            clear_table();
+        }
+
+        // Loads build records into the hash table, stopping once they exceed the memory budget
+        // Returns true if loading stopped before the end of the build records
+        bool load_build(basic_reader<Parser,FileReader,Dialect>& build_reader) {
+            while (true) {
+                build_rows.emplace_back();
+                if (!build_reader.next(build_rows.back())) {
+                    build_rows.pop_back();
+                    return false;
+                }
+                if (!insert_last_row()) { continue; }
+                if (build_bytes > options.memory_budget) { return true; }
+            }
+        }
+
+        // Partitions the loaded build records followed by the rest of both readers and empties the hash table
+        // Returns the paths of the build and probe partitions
+        std::pair<std::vector<std::filesystem::path>, std::vector<std::filesystem::path>> partition_files(
+            basic_reader<Parser,FileReader,Dialect>& build_reader, basic_reader<Parser,FileReader,Dialect>& probe_reader, std::size_t level) {
+            auto build_partitions = open_partitions();
+            auto probe_partitions = open_partitions();
+            for (auto& record : build_rows) {
+                write_partition(build_partitions, record, build_key, false, level);
+            }
+            clear_table();
+            for (basic_record<Dialect> record; build_reader.next(record);) {
+                build_field_count = std::max(build_field_count, record.get_field_count());
+                write_partition(build_partitions, record, build_key, false, level);
+            }
+            // Records without a key never match, only a left join keeps them on the probe side
+            for (basic_record<Dialect> record; probe_reader.next(record);) {
+                write_partition(probe_partitions, record, probe_key, options.kind == join_kind::left, level);
+            }
+            // Writers are flushed as the partition sets are destroyed, before the partitions are read back
+            return { std::move(build_partitions.paths), std::move(probe_partitions.paths) };
+        }
+
+        // Adds the last build record to the hash table. Records without a key are dropped
+        bool insert_last_row() {
+            auto& record = build_rows.back();
+            build_field_count = std::max(build_field_count, record.get_field_count());
+            auto key = key_of(record, build_key);
+            if (key.empty()) {
+                build_rows.pop_back();
+                return false;
+            }
+
+            auto row = static_cast<std::uint32_t>(build_rows.size() - 1);
+            next_row.push_back(no_row);
+            auto entry = table.find(key);
+            if (entry == table.end()) {
+                table.emplace(keys.store(key), row);
+            }
+            else {
+                // Chained in front, so records sharing a key are visited from the last one read
+                next_row[row] = entry->second;
+                entry->second = row;
+            }
+            // Record with its buffers and field views, chain entry and table node
+            build_bytes += sizeof(basic_record<Dialect>) + record.get_raw_size() + record.get_field_count() * sizeof(std::string_view) +
+                sizeof(std::uint32_t) + key.size() + 4 * sizeof(void*);
+            return true;
+        }
+
+        template<typename Match, typename BatchDone>
+        void probe_table(basic_reader<Parser,FileReader,Dialect>& probe_reader, Match& match, BatchDone& batch_done) {
+            // Field views of the shared build records are generated up front, the probing threads only read them
+            for (auto& record : build_rows) { record.get_fields(); }
+
+            auto probe_batch = [&](std::size_t worker_index, std::vector<basic_record<Dialect>>& batch) {
+                for (auto& record : batch) {
+                    auto key = key_of(record, probe_key);
+                    bool matched = false;
+                    if (!key.empty()) {
+                        if (auto entry = table.find(key); entry != table.end()) {
+                            for (auto row = entry->second; row != no_row; row = next_row[row]) {
+                                match(worker_index, record, &build_rows[row]);
+                            }
+                            matched = true;
+                        }
+                    }
+                    if (!matched && options.kind == join_kind::left) {
+                        match(worker_index, record, nullptr);
+                    }
+                }
+                batch_done(worker_index);
+            };
+
+            process_batches<Dialect>([&probe_reader](basic_record<Dialect>& record) {return probe_reader.next(record);},
+                options.thread_count, options.batch_size, probe_batch);
+        }
+
+        void clear_table() {
+            build_rows.clear();
+            keys.clear();
+            table.clear();
+            next_row.clear();
+            build_bytes = 0;
+        }
+
+        static std::string_view key_of(basic_record<Dialect>& record, std::size_t column) {
+            auto& fields = record.get_fields();
+            if (column >= fields.size()) { return {}; }
+            return trim_field(fields[column], Dialect::get_escapecharacter());
+        }
+
+        partition_set open_partitions() {
+            partition_set partitions;
+            for (std::size_t partition = 0; partition < options.partition_count; partition++) {
+                auto name = "turbo_csv_join_" + std::to_string(reinterpret_cast<std::uintptr_t>(this)) + "_" + std::to_string(partition_counter++) + ".csv";
+                partitions.paths.push_back(options.temp_directory / name);
+                spilled_partitions.push_back(partitions.paths.back());
+                partitions.writers.push_back(std::make_unique<basic_writer<Dialect>>(partitions.paths.back().string(), 1 << 16));
+            }
+            return partitions;
+        }
+
+        // Every level of partitioning hashes with its own seed, otherwise the records of a partition would all end up
+        // in the same partition again
+        void write_partition(partition_set& partitions, basic_record<Dialect>& record, std::size_t column, bool keep_keyless, std::size_t level) {
+            auto key = key_of(record, column);
+            if (key.empty() && !keep_keyless) { return; }
+            partitions.writers[sketch_hash(key, level) % partitions.writers.size()]->write(record);
+        }
+
+        static void remove_partitions(const std::vector<std::filesystem::path>& partitions) {
+            for (auto& partition : partitions) {
+                std::error_code ignored;
+                std::filesystem::remove(partition, ignored);
+            }
+        }
+    };
+
+    using joiner = basic_joiner<parser,adapted_fstream,dialect>;
+}
+
+#endif
@@ -0,0 +1,302 @@
+#ifndef MULTI_READER_HPP
+#define MULTI_READER_HPP
+
+#include<atomic>
+#include<algorithm>
+#include<memory>
+#include<thread>
+#include<vector>
+#include<string>
+#include<filesystem>
+#include<stdexcept>
+#include<exception>
+#include<unordered_map>
+#include<record.hpp>
+#include<concurrent_queue.hpp>
+#include<thread_placement.hpp>
+#include<turbo_parser.hpp>
+#include<fstream_adaptor.hpp>
+#include<dialect.hpp>
+
+namespace turbo_csv {
+
+    /**
+     * @brief Order in which records of different shards are handed out
+     *
+     * ordered   : all records of shard 0, then shard 1 ... (same as reading the files one after the other)
+     * unordered : batches are handed out as soon as any shard produced them (fastest)
+     */
+    enum class merge_order { ordered, unordered };
+
+    /**
+     * @brief Expands a glob pattern into a sorted list of paths
+     *
+     * @param pattern path whose last component may contain '*' and '?' wildcards (eg. "drops/part-*.csv")
+     * @return std::vector<std::string> sorted list of matching regular files
+     */
+    inline std::vector<std::string> glob_paths(const std::string& pattern) {
+
+        auto wildcard_match = [](std::string_view pattern, std::string_view name) {
+            std::size_t p = 0, n = 0, star = std::string_view::npos, star_match = 0;
+            while (n < name.size()) {
+                if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) { ++p;++n; }
+                else if (p < pattern.size() && pattern[p] == '*') { star = p++;star_match = n; }
+                else if (star != std::string_view::npos) { p = star + 1;n = ++star_match; }
+                else { return false; }
+            }
+            while (p < pattern.size() && pattern[p] == '*') { ++p; }
+            return p == pattern.size();
+        };
+
+        std::filesystem::path pattern_path(pattern);
+        auto directory = pattern_path.has_parent_path() ? pattern_path.parent_path() : std::filesystem::path(".");
+        auto file_pattern = pattern_path.filename().string();
+
+        std::vector<std::string> paths;
+        for (auto& entry : std::filesystem::directory_iterator(directory)) {
+            if (entry.is_regular_file() && wildcard_match(file_pattern, entry.path().filename().string())) {
+                paths.push_back(entry.path().string());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    template<template<class,class>class Parser,class FileReader,class Dialect>
+    class basic_multi_reader {
+    public:
+        using record_batch = std::vector<basic_record<Dialect>>;
+
+    private:
+        std::vector<std::string> shard_paths;
+        bool treat_first_record_as_header;
+        merge_order order;
+        std::size_t batch_size;
+
+        basic_record<Dialect> header;
+        std::unordered_map<std::string,std::size_t> header_record;
+
+        // ordered: one queue per shard, unordered: one queue shared by all the shards
+        std::vector<std::unique_ptr<bounded_queue<record_batch>>> batch_queues;
+        // Batches handed back by the consumer. Their records are refilled by the workers
+        bounded_queue<record_batch> free_batches;
+
+        std::vector<std::thread> workers;
+        std::atomic<std::size_t> next_shard = 0;
+        std::atomic<std::size_t> active_workers = 0;
+        std::atomic_bool stop_workers = false;
+
+        std::mutex error_resx;
+        std::exception_ptr error;
+
+        std::size_t current_queue = 0;
+        record_batch current_batch;
+        std::size_t current_position = 0;
+
+    public:
+
+        /**
+         * @brief Construct a new multi reader object and starts parsing the shards concurrently
+         *
+         * @param paths paths of the csv shards sharing the same schema (see glob_paths)
+         * @param treat_first_record_as_header every shard starts with a header that must match the first shard
+         * @param order order in which records are handed out
+         * @param thread_count number of shards parsed concurrently
+         * @param batch_size number of records handed over from a worker at once
+         * @throw std::runtime_error if paths is empty
+         */
+        basic_multi_reader(std::vector<std::string> paths, bool treat_first_record_as_header = false,
+            merge_order order = merge_order::ordered,
+            std::size_t thread_count = std::thread::hardware_concurrency(),
+            std::size_t batch_size = 1024) :
+            shard_paths(std::move(paths)),
+            treat_first_record_as_header(treat_first_record_as_header),
+            order(order),
+            batch_size(batch_size == 0 ? 1 : batch_size),
+            free_batches(4 * std::max<std::size_t>(thread_count, 1)) {
+
+            if (shard_paths.empty()) {
+                throw std::runtime_error("turbo_csv::multi_reader: no shards to read");
+            }
+
+            if (treat_first_record_as_header) {
+                // The header is checked once here, every shard is compared against it while parsing
+                Parser<FileReader,Dialect> header_parser(shard_paths.front());
+                header_parser.next(header);
+                std::size_t index = 0;
+                for (auto& field : header.get_fields()) {
+                    header_record.insert(std::make_pair(std::string(field), index++));
+                }
+            }
+
+            auto queue_count = order == merge_order::ordered ? shard_paths.size() : 1;
+            for (std::size_t i = 0; i < queue_count; i++) {
+                batch_queues.push_back(std::make_unique<bounded_queue<record_batch>>(4));
+            }
+
+            thread_count = std::clamp<std::size_t>(thread_count, 1, shard_paths.size());
+            active_workers = thread_count;
+            for (std::size_t i = 0; i < thread_count; i++) {
+                workers.emplace_back([this, i]() {
+                    placement::place_worker(i);
+                    this->parse_shards();
+                });
+            }
+        }
+
+        basic_multi_reader(const basic_multi_reader&) = delete;
+        basic_multi_reader& operator=(const basic_multi_reader&) = delete;
+
+        ~basic_multi_reader() {
+            stop_workers.store(true);
+            free_batches.close();
+            for (auto& queue : batch_queues) { queue->close(); }
+            for (auto& worker : workers) { worker.join(); }
+        }
+
+        /**
+         * @brief Refills the supplied record with the next record from the shards
+         *
+         * @param record record to be refilled ( its buffers are swapped with the ones of the batch )
+         * @return true record contains the next row
+         * @return false all the shards are read completely
+         * @throw std::runtime_error if the header of a shard does not match the first shard
+         */
+        bool next(basic_record<Dialect>& record) {
+            if (current_position == current_batch.size()) {
+                if (!next_batch(current_batch)) { return false; }
+                current_position = 0;
+            }
+            std::swap(record, current_batch[current_position++]);
+            return true;
+        }
+
+        /**
+         * @brief Replaces the contents of batch with the next batch of records. The records previously
+         * held by batch are recycled by the workers
+         *
+         * @param batch batch to be refilled
+         * @return true batch contains the next records
+         * @return false all the shards are read completely
+         * @throw std::runtime_error if the header of a shard does not match the first shard
+         */
+        bool next_batch(record_batch& batch) {
+            while (true) {
+                rethrow_worker_error();
+                if (current_queue == batch_queues.size()) { return false; }
+
+                auto produced = batch_queues[current_queue]->pop();
+                if (produced.has_value()) {
+                    if (!batch.empty()) { free_batches.try_push(batch); }
+                    batch = std::move(produced.value());
+                    return true;
+                }
+                // Shard (or all the shards for unordered mode) completely consumed
+                ++current_queue;
+            }
+        }
+
+        /**
+         * @brief Returns the index of the associated column in the shared header
+         *
+         * @param column_name name of the column whose index needs to be found
+         * @return std::size_t index of the associated column
+         */
+        std::size_t get_indexof(const std::string& column_name) {
+            return header_record.at(column_name);
+        }
+
+        /**
+         * @brief Returns the number of shards being read
+         *
+         * @return std::size_t count of shards
+         */
+        std::size_t get_shardcount() {
+            return shard_paths.size();
+        }
+
+    private:
+
+        void parse_shards() {
+            try {
+                while (!stop_workers.load()) {
+                    auto shard = next_shard++;
+                    if (shard >= shard_paths.size()) { break; }
+
+                    auto& queue = order == merge_order::ordered ? *batch_queues[shard] : *batch_queues.front();
+                    parse_shard(shard, queue);
+                    if (order == merge_order::ordered) { queue.close(); }
+                }
+            }
+            catch (...) {
+                fail(std::current_exception());
+            }
+            if (--active_workers == 0 && order == merge_order::unordered) {
+                batch_queues.front()->close();
+            }
+        }
+
+        void parse_shard(std::size_t shard, bounded_queue<record_batch>& queue) {
+            // Parsers are allocated on heap as buffered file readers can be quite large
+            auto csv_parser = std::make_unique<Parser<FileReader,Dialect>>(shard_paths[shard]);
+
+            auto batch = acquire_batch();
+            std::size_t count = 0;
+
+            if (treat_first_record_as_header) {
+                batch.resize(std::max<std::size_t>(batch.size(), 1));
+                csv_parser->next(batch.front());
+                if (shard != 0 && batch.front().get_fields() != header.get_fields()) {
+                    throw std::runtime_error("turbo_csv::multi_reader: header of " + shard_paths[shard] + " does not match " + shard_paths.front());
+                }
+            }
+
+            while (!stop_workers.load()) {
+                if (count == batch.size()) { batch.emplace_back(); }
+                if (!csv_parser->next(batch[count])) { break; }
+
+                if (++count == batch_size) {
+                    if (!queue.push(std::move(batch))) { return; }
+                    batch = acquire_batch();
+                    count = 0;
+                }
+            }
+
+            if (count != 0) {
+                batch.resize(count);
+                queue.push(std::move(batch));
+            }
+        }
+
+        record_batch acquire_batch() {
+            auto batch = free_batches.try_pop();
+            if (batch.has_value()) {
+                // Only keep as many records as a batch can hold, the rest are refilled in place
+                batch->resize(std::min(batch->size(), batch_size));
+                return std::move(batch.value());
+            }
+            record_batch new_batch;
+            new_batch.reserve(batch_size);
+            return new_batch;
+        }
+
+        void fail(std::exception_ptr worker_error) {
+            {
+                std::lock_guard<std::mutex> lck(error_resx);
+                if (!error) { error = worker_error; }
+            }
+            stop_workers.store(true);
+            for (auto& queue : batch_queues) { queue->close(); }
+        }
+
+        void rethrow_worker_error() {
+            std::lock_guard<std::mutex> lck(error_resx);
+            if (error) { std::rethrow_exception(error); }
+        }
+
+    };
+
+    using multi_reader = basic_multi_reader<parser,adapted_fstream,dialect>;
+}
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef PIPELINE_STATS_HPP
+#define PIPELINE_STATS_HPP
+
+#include<atomic>
+#include<chrono>
+#include<string>
+#include<cstdint>
+
+namespace turbo_csv {
+
+    /**
+     * @brief Counter updated by a single thread
+     *
+     */
+    template<bool Enabled>
+    class basic_stats_counter {
+        std::uint64_t value = 0;
+    public:
+        void add(std::uint64_t count = 1) noexcept { value += count; }
+        std::uint64_t get() const noexcept { return value; }
+    };
+
+    template<>
+    class basic_stats_counter<false> {
+    public:
+        void add(std::uint64_t = 1) noexcept {}
+        std::uint64_t get() const noexcept { return 0; }
+    };
+
+    /**
+     * @brief Counter updated by one thread (eg. producer of file_reader) and read by another
+     *
+     */
+    template<bool Enabled>
+    class basic_shared_stats_counter {
+        std::atomic<std::uint64_t> value = 0;
+    public:
+        void add(std::uint64_t count = 1) noexcept { value.fetch_add(count, std::memory_order_relaxed); }
+        std::uint64_t get() const noexcept { return value.load(std::memory_order_relaxed); }
+    };
+
+    template<>
+    class basic_shared_stats_counter<false> {
+    public:
+        void add(std::uint64_t = 1) noexcept {}
+        std::uint64_t get() const noexcept { return 0; }
+    };
+
+    /**
+     * @brief Adds the nanoseconds spent in a scope to a counter
+     *
+     */
+    template<typename Counter, bool Enabled>
+    class basic_stats_timer {
+        Counter& counter;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    public:
+        basic_stats_timer(Counter& counter) noexcept :counter(counter) {}
+        ~basic_stats_timer() {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            counter.add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    };
+
+    template<typename Counter>
+    class basic_stats_timer<Counter, false> {
+    public:
+        basic_stats_timer(Counter&) noexcept {}
+    };
+
+    /**
+     * @brief Whether a file reader collects statistics. Statistics are part of the type of the file reader
+     * ( eg. file_reader<buffer_size,true>, stats_adapted_fstream ) and the parser reading from it collects its own
+     * along with them. Otherwise all the counters are empty types and every update compiles away
+     *
+     * @tparam FileReader file reader type
+     */
+    template<typename FileReader>
+    inline constexpr bool collects_stats = requires { requires FileReader::stats_enabled; };
+
+    /**
+     * @brief Snapshot of the statistics of a reading pipeline. Every component fills in the values it knows about
+     *
+     * bytes_read       : bytes read from the file by the file reader
+     * refill_count     : number of times a file reader buffer was refilled
+     * consumer_wait_ns : time the parser spent waiting for a buffer to be filled ( switch_buffer )
+     * producer_fill_ns : time the producer thread spent filling buffers ( fill_buffer )
+     * records          : number of records parsed
+     * fields           : number of fields in the parsed records
+     * buffer_growths   : number of times the buffers of a record ( raw data, escape positions ) grew while parsing,
+     *                    other allocations are not counted
+     * deque_size       : number of records cached by the reader
+     * elapsed_seconds  : time since the reader was created
+     */
+    struct pipeline_stats {
+        std::uint64_t bytes_read = 0;
+        std::uint64_t refill_count = 0;
+        std::uint64_t consumer_wait_ns = 0;
+        std::uint64_t producer_fill_ns = 0;
+        std::uint64_t records = 0;
+        std::uint64_t fields = 0;
+        std::uint64_t buffer_growths = 0;
+        std::uint64_t deque_size = 0;
+        double elapsed_seconds = 0;
+
+        double records_per_second() const {
+            return elapsed_seconds > 0 ? static_cast<double>(records) / elapsed_seconds : 0;
+        }
+
+        double average_fields_per_record() const {
+            return records != 0 ? static_cast<double>(fields) / static_cast<double>(records) : 0;
+        }
+
+        /**
+         * @brief Serializes the snapshot as a flat json object ( for exporting to monitoring systems )
+         *
+         * @return std::string json representation of the snapshot
+         */
+        std::string to_json() const {
+            return "{\"bytes_read\":" + std::to_string(bytes_read) +
+                ",\"refill_count\":" + std::to_string(refill_count) +
+                ",\"consumer_wait_ns\":" + std::to_string(consumer_wait_ns) +
+                ",\"producer_fill_ns\":" + std::to_string(producer_fill_ns) +
+                ",\"records\":" + std::to_string(records) +
+                ",\"fields\":" + std::to_string(fields) +
+                ",\"buffer_growths\":" + std::to_string(buffer_growths) +
+                ",\"deque_size\":" + std::to_string(deque_size) +
+                ",\"elapsed_seconds\":" + std::to_string(elapsed_seconds) +
+                ",\"records_per_second\":" + std::to_string(records_per_second()) +
+                ",\"average_fields_per_record\":" + std::to_string(average_fields_per_record()) + "}";
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef PROFILE_HPP
+#define PROFILE_HPP
+
+#include<limits>
+#include<string>
+#include<thread>
+#include<vector>
+#include<algorithm>
+#include<turbo_csv.hpp>
+#include<sketches.hpp>
+#include<field_utils.hpp>
+#include<batch_pipeline.hpp>
+
+namespace turbo_csv {
+
+    /**
+     * @brief Parameters of the sketches of a column profile
+     *
+     * distinct_precision   : precision of the HyperLogLog sketch ( 2^precision bytes per column and thread )
+     * quantile_compression : compression of the t-digest ( about as many centroids per column and thread )
+     */
+    struct sketch_options {
+        unsigned distinct_precision = 12;
+        double quantile_compression = 100;
+    };
+
+    /**
+     * @brief Profile of a column computed in bounded memory
+     *
+     * column        : index of the column
+     * null_count    : fields that are empty ( after trimming spaces and quotes ) or missing from the record
+     * value_count   : fields that are not null
+     * numeric_count : values that are numbers ( numeric_min/numeric_max/quantile only describe those )
+     * min/max       : smallest/largest value in byte order
+     */
+    struct column_profile {
+        std::size_t column = 0;
+        std::uint64_t null_count = 0;
+        std::uint64_t value_count = 0;
+        std::uint64_t numeric_count = 0;
+        std::string min;
+        std::string max;
+        double numeric_min = std::numeric_limits<double>::infinity();
+        double numeric_max = -std::numeric_limits<double>::infinity();
+        hyperloglog distinct;
+        tdigest quantiles;
+
+        column_profile(std::size_t column = 0, const sketch_options& options = {}) :
+            column(column), distinct(options.distinct_precision), quantiles(options.quantile_compression) {}
+
+        /**
+         * @brief Returns the approximate number of distinct values ( nulls are not counted )
+         *
+         * @return double estimate
+         */
+        double approximate_distinct() const {
+            return distinct.estimate();
+        }
+
+        /**
+         * @brief Returns the approximate quantile of the numeric values
+         *
+         * @param q quantile in [0,1] ( eg. 0.5 for the median )
+         * @return double estimate ( NaN if the column has no numeric value )
+         */
+        double quantile(double q) {
+            return quantiles.quantile(q);
+        }
+
+        void add(std::string_view value) {
+            if (value.empty()) {
+                null_count++;
+                return;
+            }
+            if (value_count == 0 || value < min) { min.assign(value); }
+            if (value_count == 0 || value > max) { max.assign(value); }
+            value_count++;
+            distinct.add(value);
+
+            double number;
+            if (parse_number(value, number)) {
+                numeric_count++;
+                numeric_min = std::min(numeric_min, number);
+                numeric_max = std::max(numeric_max, number);
+                quantiles.add(number);
+            }
+        }
+
+        void merge(const column_profile& other) {
+            if (other.value_count != 0) {
+                if (value_count == 0 || other.min < min) { min = other.min; }
+                if (value_count == 0 || other.max > max) { max = other.max; }
+            }
+            null_count += other.null_count;
+            value_count += other.value_count;
+            numeric_count += other.numeric_count;
+            numeric_min = std::min(numeric_min, other.numeric_min);
+            numeric_max = std::max(numeric_max, other.numeric_max);
+            distinct.merge(other.distinct);
+            quantiles.merge(other.quantiles);
+        }
+    };
+
+    /**
+     * @brief Profiles columns of the remaining records of the reader in a single streaming pass. Records are not
+     * retained, every thread sketches the batches it is handed into its own profiles which are merged at the end,
+     * so memory only depends on the number of columns and threads
+     *
+     * @param csv_reader reader whose remaining records are profiled
+     * @param columns indices of the profiled columns
+     * @param options parameters of the sketches
+     * @param thread_count number of profiling threads
+     * @param batch_size number of records handed to a thread at once
+     * @return std::vector<column_profile> profiles in the order of columns
+     */
+    template<template<class,class>class Parser,class FileReader,class Dialect>
+    std::vector<column_profile> profile_columns(basic_reader<Parser,FileReader,Dialect>& csv_reader,
+        const std::vector<std::size_t>& columns, const sketch_options& options = {},
+        std::size_t thread_count = std::thread::hardware_concurrency(), std::size_t batch_size = 1024) {
+
+        thread_count = std::max<std::size_t>(thread_count, 1);
+        std::vector<std::vector<column_profile>> partial_profiles(thread_count);
+        for (auto& profiles : partial_profiles) {
+            for (auto column : columns) { profiles.emplace_back(column, options); }
+        }
+
+        auto profile_batch = [&](std::size_t worker_index, std::vector<basic_record<Dialect>>& batch) {
+            auto& profiles = partial_profiles[worker_index];
+            auto escape_character = Dialect::get_escapecharacter();
+
+            for (auto& record : batch) {
+                auto& fields = record.get_fields();
+                for (auto& profile : profiles) {
+                    if (profile.column < fields.size()) {
+                        profile.add(trim_field(fields[profile.column], escape_character));
+                    }
+                    else {
+                        profile.null_count++;
+                    }
+                }
+            }
+        };
+
+        process_batches<Dialect>([&csv_reader](basic_record<Dialect>& record) {return csv_reader.next(record);},
+            thread_count, batch_size, profile_batch);
+
+        auto& merged = partial_profiles.front();
+        for (std::size_t i = 1; i < partial_profiles.size(); i++) {
+            for (std::size_t column = 0; column < merged.size(); column++) {
+                merged[column].merge(partial_profiles[i][column]);
+            }
+        }
+        return std::move(merged);
+    }
+
+}
+
+#endif
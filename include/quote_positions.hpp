@@ -0,0 +1,121 @@
+#ifndef QUOTE_POSITIONS_HPP
+#define QUOTE_POSITIONS_HPP
+
+#include<vector>
+#include<cstdint>
+#include<stdexcept>
+#include<algorithm>
+
+namespace turbo_csv {
+
+    /**
+     * @brief Sorted positions of the escape characters of a record, relative to the beginning of the record.
+     * Positions are stored in 16 bits while the record is shorter than 64KB and widened to 32 bits once a
+     * position does not fit. Records without quotes never allocate
+     *
+     */
+    class quote_positions {
+        std::vector<std::uint16_t> narrow;
+        std::vector<std::uint32_t> wide;
+        bool widened = false;
+
+    public:
+
+        /**
+         * @brief Appends the position of the next escape character
+         *
+         * @param position position relative to the beginning of the record ( must be larger than the previous one )
+         * @throw std::length_error if the record is larger than 4GB
+         */
+        void push_back(std::size_t position) {
+            if (!widened) {
+                if (position <= UINT16_MAX) {
+                    narrow.push_back(static_cast<std::uint16_t>(position));
+                    return;
+                }
+                widen();
+            }
+            if (position > UINT32_MAX) {
+                throw std::length_error("turbo_csv::quote_positions: records larger than 4GB are not supported");
+            }
+            wide.push_back(static_cast<std::uint32_t>(position));
+        }
+
+        std::size_t size() const noexcept {
+            return widened ? wide.size() : narrow.size();
+        }
+
+        std::size_t capacity() const noexcept {
+            return widened ? wide.capacity() : narrow.capacity();
+        }
+
+        bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        std::size_t operator[](std::size_t index) const noexcept {
+            return widened ? wide[index] : narrow[index];
+        }
+
+        std::size_t back() const noexcept {
+            return widened ? wide.back() : narrow.back();
+        }
+
+        void pop_back() noexcept {
+            if (widened) { wide.pop_back(); }
+            else { narrow.pop_back(); }
+        }
+
+        /**
+         * @brief Keeps only the first count positions
+         *
+         */
+        void truncate(std::size_t count) noexcept {
+            if (count >= size()) { return; }
+            if (widened) { wide.resize(count); }
+            else { narrow.resize(count); }
+        }
+
+        /**
+         * @brief Removes every position but keeps the capacity for reuse
+         *
+         */
+        void clear() noexcept {
+            narrow.clear();
+            wide.clear();
+            widened = false;
+        }
+
+        /**
+         * @brief Returns the number of escape characters before position ( odd means position is inside quotes )
+         *
+         * @param position position relative to the beginning of the record
+         * @return std::size_t number of escape characters at smaller positions
+         */
+        std::size_t count_before(std::size_t position) const noexcept {
+            if (widened) {
+                return static_cast<std::size_t>(std::lower_bound(wide.begin(), wide.end(), position) - wide.begin());
+            }
+            return static_cast<std::size_t>(std::lower_bound(narrow.begin(), narrow.end(), position) - narrow.begin());
+        }
+
+        /**
+         * @brief Returns the number of bytes used by the positions
+         *
+         */
+        std::size_t memory_size() const noexcept {
+            return narrow.capacity() * sizeof(std::uint16_t) + wide.capacity() * sizeof(std::uint32_t);
+        }
+
+    private:
+
+        void widen() {
+            wide.assign(narrow.begin(), narrow.end());
+            narrow.clear();
+            widened = true;
+        }
+    };
+
+}
+
+#endif
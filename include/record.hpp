@@ -2,20 +2,41 @@
 #define RECORD_HPP
 
 #include<algorithm>
+#include<concepts>
+#include<memory>
+#include<span>
 #include<vector>
+#include<ranges>
 #include<string_view>
 #include<boost/lexical_cast.hpp>
 #include<dialect.hpp>
+#include<simd_scan.hpp>
+#include<quote_positions.hpp>
 #include<boost/range/adaptor/reversed.hpp>
 
 namespace turbo_csv{
+    template<typename FileReader, typename Dialect>
+    class parser;
+
     template<typename Dialect>
     class basic_record{
-        std::vector<int>escape_char_pos;
+        quote_positions escape_char_pos;
         std::string raw_record;
         std::vector<std::string_view> fields;
         bool is_cached=false;
 
+        // Unescaped fields decoded so far ( a null data pointer marks a field not decoded yet ) and the arena
+        // holding the ones that had to be rewritten. Allocated on first use to keep records cached by the reader small
+        struct unescape_cache{
+            std::vector<std::string_view> fields;
+            std::string arena;
+        };
+        std::unique_ptr<unescape_cache> unescaped;
+
+        // Parser refills the raw data and escape positions in place (see parser::next(basic_record&))
+        template<typename FileReader, typename D>
+        friend class parser;
+
         public:
 
         /**
@@ -29,10 +50,23 @@ namespace turbo_csv{
          * @brief Construct a new record object
          * 
          * @param raw_rec Raw record data
-         * @param escape_char_pos vector of all the escape character position in the record
+         * @param escape_char_pos positions of all the escape characters in the record ( relative to the record, ascending )
+         */
+        basic_record(const std::string& raw_rec,const std::vector<std::size_t>& escape_char_pos):raw_record(raw_rec){
+            for(auto position:escape_char_pos){this->escape_char_pos.push_back(position);}
+        }
+
+        /**
+         * @brief Construct a new record object from int escape positions ( the former signature )
+         *
+         * @param raw_rec Raw record data
+         * @param escape_char_pos positions of all the escape characters in the record ( relative to the record, ascending )
+         * @note A template so that braced lists of positions keep choosing the std::size_t overload
          */
-        basic_record(const std::string& raw_rec,std::vector<int> escape_char_pos):raw_record(raw_rec),escape_char_pos(std::move(escape_char_pos))
-        {}
+        template<typename Int> requires std::same_as<Int,int>
+        [[deprecated("escape positions are std::size_t, use basic_record(const std::string&,const std::vector<std::size_t>&)")]]
+        basic_record(const std::string& raw_rec,std::vector<Int> escape_char_pos):
+            basic_record(raw_rec,std::vector<std::size_t>(escape_char_pos.begin(),escape_char_pos.end())){}
 
         /**
          * @brief Construct a new record object
@@ -42,6 +76,42 @@ namespace turbo_csv{
          */
         basic_record(const std::string& raw_rec):basic_record(raw_rec,{}){}
 
+        /**
+         * @brief Copy constructs a record
+         * 
+         * @note The field views are not copied as they point inside the other record. They are
+         * regenerated lazily on first use
+         */
+        basic_record(const basic_record& other):escape_char_pos(other.escape_char_pos),raw_record(other.raw_record){}
+
+        /**
+         * @brief Move constructs a record
+         * 
+         * @note The field views are kept only if the raw buffer was stolen from the other record
+         * ( Small strings are copied by the move and would leave the views dangling )
+         */
+        basic_record(basic_record&& other)noexcept{
+            steal(other);
+        }
+
+        basic_record& operator=(const basic_record& other){
+            if(this!=std::addressof(other)){
+                escape_char_pos=other.escape_char_pos;
+                raw_record=other.raw_record;
+                fields.clear();
+                is_cached=false;
+                clear_unescaped();
+            }
+            return *this;
+        }
+
+        basic_record& operator=(basic_record&& other)noexcept{
+            if(this!=std::addressof(other)){
+                steal(other);
+            }
+            return *this;
+        }
+
 
         /**
          * @brief Get the raw size object
@@ -84,6 +154,25 @@ namespace turbo_csv{
             return fields;
         }
 
+        /**
+         * @brief Returns the fields as a contiguous range ( composes with std::views )
+         * 
+         * @return std::span<const std::string_view> view over the fields collection
+         */
+        std::span<const std::string_view> field_range(){
+            return get_fields();
+        }
+
+        /**
+         * @brief Returns a lazy range of the unescaped fields, a field is only decoded when it is accessed
+         * 
+         * @return range of std::string_view ( see get_unescaped_field )
+         */
+        auto unescaped_field_range(){
+            return std::views::iota(std::size_t(0),std::size_t(get_field_count()))
+                |std::views::transform([this](std::size_t field_index){return get_unescaped_field(static_cast<int>(field_index));});
+        }
+
         /**
          * @brief returns the field value at given field index (in string form)
          * 
@@ -122,8 +211,91 @@ namespace turbo_csv{
             return boost::lexical_cast<T>(field_view);
         }
 
+        /**
+         * @brief returns the field value with the RFC 4180 escaping removed. The enclosing quotes are dropped and
+         * doubled quotes ( or quotes escaped with the quote escape character of the dialect ) are collapsed
+         * 
+         * @param field_index index of field
+         * @return std::string_view view into the unescaped value, valid until the record is modified
+         * @throw std::out_of_range if field_index is out of bounds
+         * @note Every field is decoded only once, on first access. Fields without escaped quotes are views into the
+         * record, the others are rewritten into a per record arena that is reused by the parser
+         */
+        std::string_view get_unescaped_field(int field_index)noexcept(false){
+            std::string_view field_view=(*this)[field_index];
+            if(!unescaped){unescaped=std::make_unique<unescape_cache>();}
+            if(unescaped->fields.size()!=fields.size()){unescaped->fields.assign(fields.size(),std::string_view());}
+            auto& unescaped_field=unescaped->fields[static_cast<std::size_t>(field_index)];
+            if(unescaped_field.data()==nullptr){unescaped_field=unescape(field_view,unescaped->arena);}
+            return unescaped_field;
+        }
+
         private:
 
+        // Decodes a single field. Fields without escaped characters are returned as views into the record, the
+        // escaped ones are located 16 bytes at a time. A quote escape character escapes unquoted characters as well
+        std::string_view unescape(std::string_view field,std::string& arena){
+            const char quote=Dialect::get_escapecharacter();
+            bool quoted=field.size()>=2&&field.front()==quote&&field.back()==quote;
+            if(quoted){field=field.substr(1,field.size()-2);}
+
+            char escape=quote;
+            if constexpr(dialect_traits<Dialect>::has_quoteescape){escape=Dialect::get_quoteescape();}
+            else if(!quoted){return field;}
+            const char* begin=field.data();
+            const char* end=field.data()+field.size();
+            const char* escaped=simd::find_first_of(begin,end,escape);
+            if(escaped==end){return field;}
+
+            // Decoded fields are never longer than the record, so reserving its size when the arena is first used
+            // keeps the views handed out before stable
+            arena.reserve(raw_record.size());
+            auto arena_begin=arena.size();
+            while(escaped!=end){
+                arena.append(begin,escaped);
+                // The escape character is dropped and the character following it is kept as it is
+                if(escaped+1!=end){arena.push_back(escaped[1]);}
+                begin=std::min(escaped+2,end);
+                escaped=simd::find_first_of(begin,end,escape);
+            }
+            arena.append(begin,end);
+            return std::string_view(arena).substr(arena_begin);
+        }
+
+        // The cache itself is kept so that records reused by the parser do not allocate again
+        void clear_unescaped()noexcept{
+            if(unescaped){
+                unescaped->fields.clear();
+                unescaped->arena.clear();
+            }
+        }
+
+        /**
+         * @brief Empties the record but keeps the capacity of its buffers for reuse
+         * 
+         */
+        void reset()noexcept{
+            raw_record.clear();
+            escape_char_pos.clear();
+            fields.clear();
+            is_cached=false;
+            clear_unescaped();
+        }
+
+        void steal(basic_record& other)noexcept{
+            const char* other_data=other.raw_record.data();
+            escape_char_pos=std::move(other.escape_char_pos);
+            raw_record=std::move(other.raw_record);
+            fields.clear();
+            is_cached=false;
+            clear_unescaped();
+            if(raw_record.data()==other_data){
+                fields=std::move(other.fields);
+                is_cached=other.is_cached;
+            }
+            other.reset();
+        }
+
         void trim(std::string_view& str_view, char trim_char=' '){
             // Remove leading spaces
                 str_view.remove_prefix(std::min(str_view.find_first_not_of(trim_char),str_view.size()));
@@ -140,6 +312,22 @@ namespace turbo_csv{
 
 
         void generate_metadata(){
+            if constexpr(!dialect_traits<Dialect>::single_byte){
+                generate_delimited_metadata();
+                return;
+            }
+            // Records without quotes are split at every seperator, located 16 bytes at a time
+            if(escape_char_pos.empty()){
+                const char* field_begin=raw_record.data();
+                const char* record_end=raw_record.data()+raw_record.size();
+                while(true){
+                    const char* field_end=simd::find_first_of(field_begin,record_end,Dialect::get_fieldseperator());
+                    fields.emplace_back(field_begin,static_cast<std::size_t>(field_end-field_begin));
+                    if(field_end==record_end){break;}
+                    field_begin=field_end+1;
+                }
+                return;
+            }
            std::string::iterator field_begin= raw_record.begin();
             std::string::iterator field_end= raw_record.begin();
 
@@ -162,19 +350,48 @@ namespace turbo_csv{
                 }
             }
         }
+        // Splits records of dialects with multi byte field seperators or a quote escape character. Candidates
+        // (first byte of the seperator, quote escape character) are located 16 bytes at a time
+        void generate_delimited_metadata(){
+            using traits=dialect_traits<Dialect>;
+            std::string_view raw(raw_record);
+            std::size_t field_begin=0,position=0;
+
+            while(true){
+                const char* candidate;
+                if constexpr(traits::has_quoteescape){
+                    candidate=simd::find_first_of(raw.data()+position,raw.data()+raw.size(),Dialect::get_fieldseperator(),Dialect::get_quoteescape());
+                }
+                else{
+                    candidate=simd::find_first_of(raw.data()+position,raw.data()+raw.size(),Dialect::get_fieldseperator());
+                }
+                position=static_cast<std::size_t>(candidate-raw.data());
+
+                if(position==raw.size()){
+                    fields.emplace_back(raw.substr(field_begin));
+                    break;
+                }
+                if(traits::is_quoteescape(raw[position])){
+                    position=std::min(position+2,raw.size());
+                }
+                else if(traits::fieldseperator_at(raw,position)&&!seperator_escaped(raw_record.begin()+static_cast<std::ptrdiff_t>(position))){
+                    fields.emplace_back(raw.substr(field_begin,position-field_begin));
+                    position+=traits::fieldseperator_size();
+                    field_begin=position;
+                }
+                else{
+                    position++;
+                }
+            }
+        }
+
         bool seperator_escaped(std::string::iterator current_iter_pos){
             // No quotes means parse it normally
             if(escape_char_pos.empty()){return false;}
 
-            auto char_pos= std::distance(raw_record.begin(),current_iter_pos);
-            auto nearest_quote =std::lower_bound(escape_char_pos.begin(),escape_char_pos.end(),char_pos);
-            
-            // Means no quotes will be there before this seperator
-            // This was written like this because of lower bound. It finds the nearest position that is greater
-            // than the current but I wanted the nearest position that is smaller so I decided to subtract the
-            // pointer
-            if(nearest_quote==escape_char_pos.begin()){return false;}
-            auto quote_count= std::distance(escape_char_pos.begin(),nearest_quote-1)+1;
+            auto char_pos= static_cast<std::size_t>(std::distance(raw_record.begin(),current_iter_pos));
+            // Number of quotes before the seperator
+            auto quote_count= escape_char_pos.count_before(char_pos);
 
             //If there are even number of quotes then the current seperator is not escaped
             if(quote_count%2==0){return false;}
@@ -0,0 +1,62 @@
+#ifndef RECORD_POOL_HPP
+#define RECORD_POOL_HPP
+
+#include<vector>
+#include<record.hpp>
+
+namespace turbo_csv {
+    template<typename Dialect>
+    class record_pool {
+        std::vector<basic_record<Dialect>> free_records;
+        std::size_t max_records;
+
+    public:
+
+        /**
+         * @brief Construct a new record pool object
+         *
+         * @param max_records maximum number of released records kept around for reuse
+         */
+        record_pool(std::size_t max_records = 16) :max_records(max_records) {
+            free_records.reserve(max_records);
+        }
+
+        /**
+         * @brief Hands out a record for refilling. Records released earlier are handed out first
+         * so that their (already grown) buffers are reused
+         *
+         * @return basic_record<Dialect> empty record
+         */
+        basic_record<Dialect> acquire() {
+            if (free_records.empty()) {
+                return basic_record<Dialect>();
+            }
+            auto record = std::move(free_records.back());
+            free_records.pop_back();
+            return record;
+        }
+
+        /**
+         * @brief Gives back a record to the pool. The record is dropped if the pool is full
+         *
+         * @param record record that is not needed by the caller anymore
+         */
+        void release(basic_record<Dialect>&& record) {
+            if (free_records.size() < max_records) {
+                free_records.push_back(std::move(record));
+            }
+        }
+
+        /**
+         * @brief Returns the number of records available for reuse
+         *
+         * @return std::size_t count of free records
+         */
+        std::size_t size() const {
+            return free_records.size();
+        }
+
+    };
+}
+
+#endif
@@ -0,0 +1,332 @@
+#ifndef SHARED_FILE_HPP
+#define SHARED_FILE_HPP
+
+#include<memory>
+#include<string>
+#include<vector>
+#include<cstdint>
+#include<optional>
+#include<algorithm>
+#include<stdexcept>
+#include<string_view>
+#include<filesystem>
+#include<system_error>
+#include<unordered_map>
+#include<record.hpp>
+#include<turbo_parser.hpp>
+#include<dialect.hpp>
+
+#ifdef __linux__
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#else
+#include<fstream>
+#include<iterator>
+#endif
+
+namespace turbo_csv {
+
+    /**
+     * @brief Read only memory mapping of a whole file. The mapping is never written to, so it can be read by any
+     * number of threads at once. Files are mapped on linux only, elsewhere they are read into memory once
+     *
+     */
+    class mapped_file {
+        const char* mapped_data = nullptr;
+        std::size_t mapped_size = 0;
+#ifndef __linux__
+        std::string contents;
+#endif
+
+    public:
+        /**
+         * @brief Maps a file into memory
+         *
+         * @param path path of the file to be mapped
+         * @throw std::system_error if the file could not be opened or mapped
+         */
+        mapped_file(const std::filesystem::path& path) {
+#ifdef __linux__
+            int file_descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (file_descriptor < 0) {
+                throw std::system_error(errno, std::generic_category(), "turbo_csv::mapped_file: open " + path.string());
+            }
+            struct stat file_stat;
+            if (::fstat(file_descriptor, &file_stat) != 0) {
+                auto error = errno;
+                ::close(file_descriptor);
+                throw std::system_error(error, std::generic_category(), "turbo_csv::mapped_file: fstat " + path.string());
+            }
+            mapped_size = static_cast<std::size_t>(file_stat.st_size);
+            // Empty files cannot be mapped, they are represented by an empty view
+            if (mapped_size != 0) {
+                void* address = ::mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+                if (address == MAP_FAILED) {
+                    auto error = errno;
+                    ::close(file_descriptor);
+                    throw std::system_error(error, std::generic_category(), "turbo_csv::mapped_file: mmap " + path.string());
+                }
+                mapped_data = static_cast<const char*>(address);
+            }
+            // The mapping stays valid once the descriptor is closed
+            ::close(file_descriptor);
+#else
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), "turbo_csv::mapped_file: open " + path.string());
+            }
+            contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            if (file.bad()) {
+                throw std::system_error(std::make_error_code(std::errc::io_error), "turbo_csv::mapped_file: read " + path.string());
+            }
+            mapped_data = contents.data();
+            mapped_size = contents.size();
+#endif
+        }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        ~mapped_file() {
+#ifdef __linux__
+            if (mapped_data != nullptr) { ::munmap(const_cast<char*>(mapped_data), mapped_size); }
+#endif
+        }
+
+        /**
+         * @brief Returns the bytes of the file
+         *
+         * @return std::string_view view into the mapping
+         */
+        std::string_view data() const noexcept {
+            return std::string_view(mapped_data, mapped_size);
+        }
+
+        std::size_t size() const noexcept {
+            return mapped_size;
+        }
+    };
+
+    /**
+     * @brief File reader handing out a byte range of a mapped file. Copies share the mapping, so a reader per
+     * thread costs neither a buffer nor a producer thread. Offsets are those of the whole file
+     *
+     */
+    class mapped_range_reader {
+        std::shared_ptr<const mapped_file> file;
+        std::uint64_t position = 0;
+        std::uint64_t range_end = 0;
+        std::size_t current_read_count = 0;
+
+    public:
+        /**
+         * @brief Construct a new mapped range reader object
+         *
+         * @param file mapped file
+         * @param begin offset of the first byte handed out
+         * @param end offset right after the last byte handed out
+         */
+        mapped_range_reader(std::shared_ptr<const mapped_file> file, std::uint64_t begin, std::uint64_t end) :
+            file(std::move(file)), position(begin), range_end(std::min<std::uint64_t>(end, this->file->size())) {}
+
+        bool is_open() {
+            return true;
+        }
+
+        auto get_filesize() {
+            return file->size();
+        }
+
+        auto get_current_readcount() {
+            return current_read_count;
+        }
+
+        std::optional<std::uint8_t> get_byte() {
+            if (position >= range_end) { return {}; }
+            current_read_count++;
+            return static_cast<std::uint8_t>(file->data()[position++]);
+        }
+
+        /**
+         * @brief Returns the bytes left in the range ( the whole remaining range is one buffer )
+         *
+         * @return std::string_view view into the mapping, empty if the range is consumed
+         */
+        std::string_view get_buffered() {
+            if (position >= range_end) { return {}; }
+            return file->data().substr(position, range_end - position);
+        }
+
+        void skip_buffered(std::size_t count) noexcept {
+            position += count;
+            current_read_count += count;
+        }
+
+        /**
+         * @brief Moves the reading position to the given byte offset in the file
+         *
+         * @param offset byte offset from the beginning of the file
+         */
+        void seek(std::uint64_t offset) {
+            position = offset;
+        }
+    };
+
+    /**
+     * @brief Cursor reading a range of rows of a shared file. It parses straight from the mapping starting at the
+     * row's offset in the index, so opening one neither reads nor scans the file
+     *
+     * @tparam Dialect dialect of the file
+     */
+    template<typename Dialect = dialect>
+    class basic_row_cursor {
+        parser<mapped_range_reader, Dialect> csv_parser;
+        std::size_t next_row;
+        std::size_t end_row;
+
+    public:
+        /**
+         * @brief Construct a new row cursor object ( see basic_shared_file::cursor )
+         *
+         * @param range_reader reader of the bytes of the rows
+         * @param begin_offset offset of the first row
+         * @param first_row index of the first row
+         * @param end_row index right after the last row
+         */
+        basic_row_cursor(mapped_range_reader range_reader, std::uint64_t begin_offset, std::size_t first_row, std::size_t end_row) :
+            csv_parser(range_reader), next_row(first_row), end_row(end_row) {
+            csv_parser.open_at(begin_offset);
+        }
+
+        /**
+         * @brief Refills the supplied record with the next row of the range
+         *
+         * @param record record to be refilled
+         * @return true record contains the next row
+         * @return false all the rows of the range were read
+         */
+        bool next(basic_record<Dialect>& record) {
+            if (next_row == end_row || !csv_parser.next(record)) { return false; }
+            next_row++;
+            return true;
+        }
+
+        /**
+         * @brief Returns the index of the row the next call to next reads
+         *
+         * @return std::size_t row index
+         */
+        std::size_t get_row() const noexcept {
+            return next_row;
+        }
+    };
+
+    /**
+     * @brief Csv file shared by many threads : the file is mapped once and the byte offset of every row is indexed
+     * once. Both are immutable afterwards, so any number of threads can read disjoint ( or overlapping ) row ranges
+     * at the same time through cursors without copying or scanning the file again
+     *
+     * @tparam Dialect dialect of the file
+     */
+    template<typename Dialect = dialect>
+    class basic_shared_file {
+        std::shared_ptr<const mapped_file> file;
+        // Offset of every row followed by the offset right after the last row
+        std::vector<std::uint64_t> row_offsets;
+
+        basic_record<Dialect> header;
+        std::unordered_map<std::string, std::size_t> header_record;
+
+    public:
+        /**
+         * @brief Maps a file and indexes its rows
+         *
+         * @param path path of the csv file
+         * @param treat_first_record_as_header exclude first record from the rows ( see get_indexof )
+         * @throw std::system_error if the file could not be mapped
+         */
+        basic_shared_file(const std::filesystem::path& path, bool treat_first_record_as_header = false) :
+            file(std::make_shared<mapped_file>(path)) {
+            // Rows are indexed by the parser itself so that row boundaries follow the dialect exactly
+            mapped_range_reader file_reader(file, 0, file->size());
+            parser<mapped_range_reader, Dialect> index_parser(file_reader);
+            basic_record<Dialect> record;
+            if (treat_first_record_as_header && index_parser.next(header)) {
+                std::size_t index = 0;
+                for (auto& field : header.get_fields()) {
+                    header_record.insert(std::make_pair(std::string(field), index));
+                    index++;
+                }
+            }
+            row_offsets.push_back(index_parser.checkpoint().offset);
+            while (index_parser.next(record)) {
+                row_offsets.push_back(index_parser.checkpoint().offset);
+            }
+            row_offsets.shrink_to_fit();
+        }
+
+        /**
+         * @brief Returns the number of rows ( the header is not a row )
+         *
+         * @return std::size_t
+         */
+        std::size_t get_rowcount() const noexcept {
+            return row_offsets.size() - 1;
+        }
+
+        /**
+         * @brief Returns the byte offset of a row
+         *
+         * @param row index of the row ( get_rowcount() for the end of the last row )
+         * @return std::uint64_t offset in the file
+         */
+        std::uint64_t get_offset(std::size_t row) const {
+            return row_offsets.at(row);
+        }
+
+        /**
+         * @brief Returns a cursor over rows [first_row,end_row)
+         *
+         * @param first_row index of the first row
+         * @param end_row index right after the last row
+         * @return basic_row_cursor<Dialect> cursor, it keeps the mapping alive ( rows beyond the file are empty )
+         */
+        basic_row_cursor<Dialect> cursor(std::size_t first_row, std::size_t end_row) const {
+            end_row = std::min(end_row, get_rowcount());
+            first_row = std::min(first_row, end_row);
+            return basic_row_cursor<Dialect>(mapped_range_reader(file, row_offsets[first_row], row_offsets[end_row]),
+                row_offsets[first_row], first_row, end_row);
+        }
+
+        basic_row_cursor<Dialect> cursor(std::size_t first_row = 0) const {
+            return cursor(first_row, get_rowcount());
+        }
+
+        /**
+         * @brief Returns the index of the associated column
+         *
+         * @param column_name name of the column whose index needs to be found
+         * @return std::size_t index of the associated column
+         * @throw std::out_of_range if no column has the name
+         */
+        std::size_t get_indexof(const std::string& column_name) const {
+            return header_record.at(column_name);
+        }
+
+        /**
+         * @brief Returns the number of bytes held by the row index ( the mapping is backed by the page cache )
+         *
+         * @return std::size_t
+         */
+        std::size_t memory_size() const noexcept {
+            return row_offsets.capacity() * sizeof(std::uint64_t);
+        }
+    };
+
+    using shared_file = basic_shared_file<dialect>;
+    using row_cursor = basic_row_cursor<dialect>;
+}
+
+#endif
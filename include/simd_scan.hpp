@@ -0,0 +1,60 @@
+#ifndef SIMD_SCAN_HPP
+#define SIMD_SCAN_HPP
+
+#include<bit>
+#include<cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include<emmintrin.h>
+#define TURBO_CSV_SSE2 1
+#endif
+
+namespace turbo_csv::simd {
+
+    /**
+     * @brief Finds the first character in [begin,end) that equals any of chars. 16 bytes are
+     * compared at once when SSE2 is available, the remaining tail is scanned byte by byte
+     *
+     * @param begin beginning of the data to be scanned
+     * @param end end of the data to be scanned
+     * @param chars characters to look for
+     * @return const char* pointer to the first match/end if none of the chars are present
+     */
+    template<typename... Chars>
+    inline const char* find_first_of(const char* begin, const char* end, Chars... chars) noexcept {
+#ifdef TURBO_CSV_SSE2
+        while (end - begin >= 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            __m128i matches = _mm_setzero_si128();
+            ((matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, _mm_set1_epi8(chars)))), ...);
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(matches));
+            if (mask != 0) {
+                return begin + std::countr_zero(mask);
+            }
+            begin += 16;
+        }
+#endif
+        for (; begin != end; ++begin) {
+            if (((*begin == chars) || ...)) {
+                return begin;
+            }
+        }
+        return end;
+    }
+
+    /**
+     * @brief Checks whether any of chars is present in [begin,end)
+     *
+     * @param begin beginning of the data to be scanned
+     * @param end end of the data to be scanned
+     * @param chars characters to look for
+     * @return true at least one of the chars is present
+     */
+    template<typename... Chars>
+    inline bool contains_any_of(const char* begin, const char* end, Chars... chars) noexcept {
+        return find_first_of(begin, end, chars...) != end;
+    }
+
+}
+
+#endif
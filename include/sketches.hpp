@@ -0,0 +1,231 @@
+#ifndef SKETCHES_HPP
+#define SKETCHES_HPP
+
+#include<bit>
+#include<cmath>
+#include<limits>
+#include<vector>
+#include<cstdint>
+#include<numbers>
+#include<algorithm>
+#include<functional>
+#include<string_view>
+
+namespace turbo_csv {
+
+    /**
+     * @brief Hashes a field for the sketches. The standard hash is finalized with the splitmix64 mixer so that
+     * the low quality of some standard library hashes does not bias the sketches
+     *
+     * @param value field to be hashed
+     * @param seed selects an independent hash function ( eg. one per level of partitioning )
+     * @return std::uint64_t well mixed 64 bit hash
+     */
+    inline std::uint64_t sketch_hash(std::string_view value, std::uint64_t seed = 0) noexcept {
+        std::uint64_t hash = std::hash<std::string_view>{}(value);
+        hash += 0x9E3779B97F4A7C15ull * (seed + 1);
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+        return hash ^ (hash >> 31);
+    }
+
+    /**
+     * @brief HyperLogLog sketch estimating the number of distinct values in 2^precision bytes. The relative
+     * standard error is about 1.04/sqrt(2^precision) ( 1.6% for the default precision )
+     *
+     */
+    class hyperloglog {
+        unsigned precision;
+        std::vector<std::uint8_t> registers;
+
+    public:
+        /**
+         * @brief Constructs an empty sketch
+         *
+         * @param precision number of bits of the hash selecting a register ( 4 to 18 )
+         */
+        hyperloglog(unsigned precision = 12) :
+            precision(std::clamp(precision, 4u, 18u)), registers(std::size_t(1) << this->precision, 0) {}
+
+        void add(std::string_view value) noexcept {
+            add_hash(sketch_hash(value));
+        }
+
+        void add_hash(std::uint64_t hash) noexcept {
+            auto index = hash >> (64 - precision);
+            // The guard bit bounds the rank when the remaining bits are all zero
+            auto remaining = (hash << precision) | (std::uint64_t(1) << (precision - 1));
+            auto rank = static_cast<std::uint8_t>(std::countl_zero(remaining) + 1);
+            registers[index] = std::max(registers[index], rank);
+        }
+
+        /**
+         * @brief Merges a sketch of the same precision ( the result estimates the distinct values of both )
+         *
+         * @param other sketch to be merged
+         */
+        void merge(const hyperloglog& other) noexcept {
+            for (std::size_t i = 0; i < registers.size() && i < other.registers.size(); i++) {
+                registers[i] = std::max(registers[i], other.registers[i]);
+            }
+        }
+
+        /**
+         * @brief Returns the estimated number of distinct values added
+         *
+         * @return double estimate
+         */
+        double estimate() const noexcept {
+            auto m = static_cast<double>(registers.size());
+            double sum = 0;
+            std::size_t zero_registers = 0;
+            for (auto rank : registers) {
+                sum += std::ldexp(1.0, -static_cast<int>(rank));
+                zero_registers += rank == 0;
+            }
+            auto alpha = 0.7213 / (1 + 1.079 / m);
+            auto raw_estimate = alpha * m * m / sum;
+            // Linear counting is more accurate for small cardinalities
+            if (raw_estimate <= 2.5 * m && zero_registers != 0) {
+                return m * std::log(m / static_cast<double>(zero_registers));
+            }
+            return raw_estimate;
+        }
+    };
+
+    /**
+     * @brief Merging t-digest estimating quantiles of a stream of numbers. Values are buffered and merged into at
+     * most about compression centroids, centroids near the tails are kept small so that extreme quantiles stay
+     * accurate
+     *
+     */
+    class tdigest {
+        struct centroid {
+            double mean;
+            double weight;
+        };
+
+        double compression;
+        std::vector<centroid> centroids;
+        std::vector<centroid> buffer;
+        double total_weight = 0;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+
+    public:
+        /**
+         * @brief Constructs an empty digest
+         *
+         * @param compression bounds the number of centroids ( larger is more accurate )
+         */
+        tdigest(double compression = 100) :compression(std::max(compression, 10.0)) {}
+
+        void add(double value, double weight = 1) {
+            if (std::isnan(value)) { return; }
+            buffer.push_back(centroid{ value, weight });
+            min = std::min(min, value);
+            max = std::max(max, value);
+            if (buffer.size() >= buffer_limit()) { compress(); }
+        }
+
+        /**
+         * @brief Merges another digest ( the result describes the values of both )
+         *
+         * @param other digest to be merged
+         */
+        void merge(const tdigest& other) {
+            buffer.insert(buffer.end(), other.centroids.begin(), other.centroids.end());
+            buffer.insert(buffer.end(), other.buffer.begin(), other.buffer.end());
+            min = std::min(min, other.min);
+            max = std::max(max, other.max);
+            compress();
+        }
+
+        /**
+         * @brief Returns the number of values added
+         *
+         * @return double total weight of the values
+         */
+        double count() const noexcept {
+            double buffered = 0;
+            for (const auto& value : buffer) { buffered += value.weight; }
+            return total_weight + buffered;
+        }
+
+        /**
+         * @brief Returns the estimated value below which a fraction q of the values lie
+         *
+         * @param q quantile in [0,1]
+         * @return double estimate ( NaN if no value was added )
+         */
+        double quantile(double q) {
+            compress();
+            if (centroids.empty()) { return std::numeric_limits<double>::quiet_NaN(); }
+            q = std::clamp(q, 0.0, 1.0);
+            if (centroids.size() == 1) { return centroids.front().mean; }
+
+            // Centroid means are taken to sit at the middle of their weight, values are interpolated between them
+            auto target = q * total_weight;
+            double cumulative = 0;
+            for (std::size_t i = 0; i < centroids.size(); i++) {
+                auto center = cumulative + centroids[i].weight / 2;
+                if (target < center) {
+                    if (i == 0) {
+                        return min + (centroids[0].mean - min) * (target / center);
+                    }
+                    auto previous_center = cumulative - centroids[i - 1].weight / 2;
+                    auto fraction = (target - previous_center) / (center - previous_center);
+                    return centroids[i - 1].mean + (centroids[i].mean - centroids[i - 1].mean) * fraction;
+                }
+                cumulative += centroids[i].weight;
+            }
+            auto last_center = total_weight - centroids.back().weight / 2;
+            auto fraction = (target - last_center) / (total_weight - last_center);
+            return centroids.back().mean + (max - centroids.back().mean) * fraction;
+        }
+
+    private:
+        std::size_t buffer_limit() const noexcept {
+            return static_cast<std::size_t>(compression) * 8;
+        }
+
+        // Scale function k1 : centroids may span 1 unit of k, which is steep near the tails
+        double scale(double q) const noexcept {
+            return compression / (2 * std::numbers::pi) * std::asin(2 * q - 1);
+        }
+
+        double inverse_scale(double k) const noexcept {
+            return (std::sin(std::clamp(k * 2 * std::numbers::pi / compression, -std::numbers::pi / 2, std::numbers::pi / 2)) + 1) / 2;
+        }
+
+        void compress() {
+            if (buffer.empty()) { return; }
+            buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+            std::sort(buffer.begin(), buffer.end(), [](const centroid& lhs, const centroid& rhs) { return lhs.mean < rhs.mean; });
+
+            total_weight = 0;
+            for (const auto& value : buffer) { total_weight += value.weight; }
+
+            centroids.clear();
+            auto current = buffer.front();
+            double merged_weight = 0;
+            auto weight_limit = total_weight * inverse_scale(scale(0) + 1);
+            for (std::size_t i = 1; i < buffer.size(); i++) {
+                if (merged_weight + current.weight + buffer[i].weight <= weight_limit) {
+                    current.weight += buffer[i].weight;
+                    current.mean += (buffer[i].mean - current.mean) * buffer[i].weight / current.weight;
+                    continue;
+                }
+                merged_weight += current.weight;
+                centroids.push_back(current);
+                weight_limit = total_weight * inverse_scale(scale(merged_weight / total_weight) + 1);
+                current = buffer[i];
+            }
+            centroids.push_back(current);
+            buffer.clear();
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,234 @@
+#ifndef THREAD_PLACEMENT_HPP
+#define THREAD_PLACEMENT_HPP
+
+#include<mutex>
+#include<string>
+#include<vector>
+#include<cstddef>
+#include<fstream>
+#include<exception>
+#include<system_error>
+#include<algorithm>
+#include<filesystem>
+#include<string_view>
+
+#ifdef __linux__
+#include<sched.h>
+#endif
+
+namespace turbo_csv {
+
+    /**
+     * @brief Where the threads started by the library run. Applies to threads started after it is set
+     *
+     * worker_cpus       : worker i ( batch workers, shard parsers, column deserializers, sort workers ) is pinned
+     *                     to worker_cpus[i % worker_cpus.size()], empty leaves the workers to the OS
+     * pair_with_creator : helper threads ( file reader producers, read ahead of async streams, sink flushers )
+     *                     are pinned to the CPUs sharing the last level cache with the CPU the thread starting
+     *                     them runs on at that time. Only the helper is pinned : the starting thread is left to
+     *                     the OS and shares the cache with its helper only as long as it stays on those CPUs
+     *                     ( pin it with placement::pin_current_thread to keep them together )
+     */
+    struct thread_placement {
+        std::vector<int> worker_cpus;
+        bool pair_with_creator = false;
+
+        /**
+         * @brief Keeps the threads started by the library on the NUMA node the calling thread runs on
+         *
+         * @return thread_placement workers spread over the CPUs of the node, helpers paired with their creator
+         */
+        static thread_placement local_node();
+    };
+
+    namespace placement {
+
+        inline std::mutex placement_resx;
+        inline thread_placement current_placement;
+
+        /**
+         * @brief Parses a kernel cpu list ( eg. "0-3,8-11" )
+         *
+         * @param list cpu list
+         * @return std::vector<int> cpus in the list
+         */
+        inline std::vector<int> parse_cpu_list(std::string_view list) {
+            std::vector<int> cpus;
+            while (!list.empty()) {
+                auto range = list.substr(0, list.find(','));
+                list.remove_prefix(std::min(list.size(), range.size() + 1));
+                auto dash = range.find('-');
+                try {
+                    int first = std::stoi(std::string(range.substr(0, dash)));
+                    int last = dash == std::string_view::npos ? first : std::stoi(std::string(range.substr(dash + 1)));
+                    for (int cpu = first; cpu <= last; cpu++) { cpus.push_back(cpu); }
+                }
+                catch (const std::exception&) {
+                    // Trailing newlines and malformed entries are skipped
+                }
+            }
+            return cpus;
+        }
+
+        inline std::vector<int> read_cpu_list(const std::filesystem::path& path) {
+            std::ifstream file(path);
+            std::string list;
+            std::getline(file, list);
+            return parse_cpu_list(list);
+        }
+
+        /**
+         * @brief Returns the cpu the calling thread runs on
+         *
+         * @return int cpu index/-1 if unknown
+         */
+        inline int current_cpu() {
+#ifdef __linux__
+            return ::sched_getcpu();
+#else
+            return -1;
+#endif
+        }
+
+        /**
+         * @brief Returns the NUMA node of a cpu
+         *
+         * @return int node index/-1 if unknown
+         */
+        inline int node_of(int cpu) {
+            if (cpu < 0) { return -1; }
+            std::error_code error;
+            std::filesystem::directory_iterator entries("/sys/devices/system/cpu/cpu" + std::to_string(cpu), error);
+            if (error) { return -1; }
+            for (const auto& entry : entries) {
+                auto name = entry.path().filename().string();
+                if (name.size() > 4 && name.compare(0, 4, "node") == 0) {
+                    try { return std::stoi(name.substr(4)); }
+                    catch (const std::exception&) {}
+                }
+            }
+            return -1;
+        }
+
+        /**
+         * @brief Returns the cpus of a NUMA node
+         *
+         * @return std::vector<int> cpus/empty if unknown
+         */
+        inline std::vector<int> node_cpus(int node) {
+            if (node < 0) { return {}; }
+            return read_cpu_list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        }
+
+        /**
+         * @brief Returns the cpus sharing the last level cache with a cpu ( its core complex )
+         *
+         * @return std::vector<int> cpus/cpus of its NUMA node if the cache topology is unknown
+         */
+        inline std::vector<int> cache_sibling_cpus(int cpu) {
+            if (cpu < 0) { return {}; }
+            std::filesystem::path cache_directory("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cache");
+            int highest_level = 0;
+            std::vector<int> siblings;
+            std::error_code error;
+            for (const auto& entry : std::filesystem::directory_iterator(cache_directory, error)) {
+                if (entry.path().filename().string().compare(0, 5, "index") != 0) { continue; }
+                int level = 0;
+                std::ifstream(entry.path() / "level") >> level;
+                if (level > highest_level) {
+                    highest_level = level;
+                    siblings = read_cpu_list(entry.path() / "shared_cpu_list");
+                }
+            }
+            return siblings.empty() ? node_cpus(node_of(cpu)) : siblings;
+        }
+
+        /**
+         * @brief Restricts the calling thread to a set of cpus
+         *
+         * @param cpus allowed cpus ( empty leaves the thread untouched )
+         * @return true thread was pinned
+         * @return false cpus is empty or pinning is not supported
+         */
+        inline bool pin_current_thread(const std::vector<int>& cpus) {
+#ifdef __linux__
+            if (cpus.empty()) { return false; }
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (auto cpu : cpus) {
+                if (cpu >= 0 && cpu < CPU_SETSIZE) { CPU_SET(cpu, &set); }
+            }
+            return ::sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+            return false;
+#endif
+        }
+
+        /**
+         * @brief Pins the calling worker thread according to the current placement
+         *
+         * @param worker_index index of the worker among the threads started together
+         */
+        inline void place_worker(std::size_t worker_index) {
+            int cpu;
+            {
+                std::lock_guard<std::mutex> lck(placement_resx);
+                if (current_placement.worker_cpus.empty()) { return; }
+                cpu = current_placement.worker_cpus[worker_index % current_placement.worker_cpus.size()];
+            }
+            pin_current_thread({ cpu });
+        }
+
+        /**
+         * @brief Placement of a helper thread. It is captured on the thread starting the helper ( the consumer )
+         * and applied on the helper itself, the consumer is not pinned
+         *
+         */
+        class helper_placement {
+            std::vector<int> cpus;
+
+        public:
+            helper_placement() {
+                bool pair_with_creator;
+                {
+                    std::lock_guard<std::mutex> lck(placement_resx);
+                    pair_with_creator = current_placement.pair_with_creator;
+                }
+                if (pair_with_creator) { cpus = cache_sibling_cpus(current_cpu()); }
+            }
+
+            void apply() const {
+                pin_current_thread(cpus);
+            }
+
+            const std::vector<int>& get_cpus() const noexcept {
+                return cpus;
+            }
+        };
+    }
+
+    inline thread_placement thread_placement::local_node() {
+        thread_placement local;
+        local.worker_cpus = placement::node_cpus(placement::node_of(placement::current_cpu()));
+        local.pair_with_creator = true;
+        return local;
+    }
+
+    /**
+     * @brief Sets where the threads started by the library from now on run
+     *
+     * @param new_placement placement of workers and helper threads
+     */
+    inline void set_thread_placement(thread_placement new_placement) {
+        std::lock_guard<std::mutex> lck(placement::placement_resx);
+        placement::current_placement = std::move(new_placement);
+    }
+
+    inline thread_placement get_thread_placement() {
+        std::lock_guard<std::mutex> lck(placement::placement_resx);
+        return placement::current_placement;
+    }
+
+}
+
+#endif
@@ -2,26 +2,45 @@
 #define TURBO_CSV_HPP
 
 #include<deque>
+#include<algorithm>
+#include<chrono>
 #include<future>
+#include<thread>
+#include<ranges>
+#include<utility>
+#include<iterator>
+#include<stdexcept>
+#include<type_traits>
 #include<record.hpp>
+#include<record_pool.hpp>
 #include<boost/range/iterator_range.hpp>
 #include<unordered_map>
 #include<turbo_parser.hpp>
 #include<csv_file_reader.hpp>
 #include<fstream_adaptor.hpp>
 #include<dialect.hpp>
+#include<zone_map.hpp>
+#include<batch_pipeline.hpp>
+#include<thread_placement.hpp>
 
 namespace turbo_csv {
     template<template<class,class>class Parser,class FileReader,class Dialect>
     class basic_reader {
         Parser<FileReader,Dialect> csv_parser;
         std::deque<basic_record<Dialect>> records;
+        record_pool<Dialect> stream_pool;
        
         bool treat_first_record_as_header;
         std::unordered_map<std::string,std::size_t> header_record;
 
         inline static basic_record<Dialect> empty_record{};
 
+        std::chrono::steady_clock::time_point created_at=std::chrono::steady_clock::now();
+
+        // Zone map built from the records read since record_zone_map was called ( until the reader is repositioned )
+        std::unique_ptr<zone_map> recorded_zones;
+        bool recording_zones=false;
+
     public:
 
         /**
@@ -53,6 +72,191 @@ namespace turbo_csv {
             }
         }
 
+        /**
+         * @brief Refills the supplied record with the next record from file. The record is not
+         * retained by the reader and its buffers are reused (no allocation per row in steady state)
+         * 
+         * @param record record to be refilled
+         * @return true record contains the next row
+         * @return false no more records are left in the file
+         */
+        bool next(basic_record<Dialect>& record) {
+            if(!csv_parser.next(record)){return false;}
+            if(recording_zones){recorded_zones->add(record,csv_parser.checkpoint());}
+            return true;
+        }
+
+        /**
+         * @brief Single pass range over the remaining records that does not retain them in reader.
+         * Every stream holds one pooled record which is refilled on each increment and handed back
+         * to the reader when the stream is destroyed
+         * 
+         */
+        class record_stream {
+            basic_reader& parent_reader;
+            basic_record<Dialect> current;
+            bool reached_end = false;
+
+        public:
+            class iterator {
+                record_stream* stream;
+            public:
+                iterator(record_stream* stream) :stream(stream) {}
+
+                basic_record<Dialect>& operator *() {
+                    return stream->current;
+                }
+
+                void operator++() {
+                    stream->advance();
+                }
+
+                bool operator !=(const iterator& rhs) {
+                    bool lhs_end = stream == nullptr || stream->reached_end;
+                    bool rhs_end = rhs.stream == nullptr || rhs.stream->reached_end;
+                    return lhs_end != rhs_end;
+                }
+            };
+
+            record_stream(basic_reader& parent_reader) :
+                parent_reader(parent_reader),
+                current(parent_reader.stream_pool.acquire()) {
+                advance();
+            }
+
+            record_stream(const record_stream&) = delete;
+            record_stream& operator=(const record_stream&) = delete;
+
+            ~record_stream() {
+                parent_reader.stream_pool.release(std::move(current));
+            }
+
+            auto begin() {
+                return iterator{ this };
+            }
+
+            auto end() {
+                return iterator{ nullptr };
+            }
+
+        private:
+            void advance() {
+                reached_end = !parent_reader.next(current);
+            }
+        };
+
+        /**
+         * @brief Returns a single pass stream over the records that are not yet read
+         * 
+         * @return record_stream stream of records 
+         */
+        record_stream stream() {
+            return record_stream{ *this };
+        }
+
+        /**
+         * @brief Lazy input view over the remaining records ( a std::ranges::view ). Only the current record is kept
+         * and a record is read when the iterator is dereferenced or compared after an increment, so pipelines such
+         * as record_range() | std::views::filter(...) | std::views::take(10) stop reading as soon as they are satisfied
+         * 
+         */
+        class record_view : public std::ranges::view_interface<record_view> {
+            basic_reader* parent_reader = nullptr;
+            basic_record<Dialect> current;
+            bool pending = true;
+            bool reached_end = false;
+
+        public:
+            class iterator {
+                record_view* view = nullptr;
+            public:
+                using value_type = basic_record<Dialect>;
+                using difference_type = std::ptrdiff_t;
+                using iterator_concept = std::input_iterator_tag;
+
+                iterator() = default;
+                explicit iterator(record_view* view) :view(view) {}
+
+                basic_record<Dialect>& operator *() const {
+                    view->fetch();
+                    return view->current;
+                }
+
+                iterator& operator++() {
+                    // Consume the current record ( it may not have been read yet ) and defer reading the next one
+                    view->fetch();
+                    view->pending = true;
+                    return *this;
+                }
+
+                void operator++(int) {
+                    ++*this;
+                }
+
+                bool operator==(std::default_sentinel_t) const {
+                    if (view == nullptr) { return true; }
+                    view->fetch();
+                    return view->reached_end;
+                }
+            };
+
+            record_view() = default;
+
+            record_view(basic_reader& parent_reader) :
+                parent_reader(&parent_reader),
+                current(parent_reader.stream_pool.acquire()) {}
+
+            record_view(record_view&& other) noexcept :
+                parent_reader(std::exchange(other.parent_reader, nullptr)),
+                current(std::move(other.current)),
+                pending(other.pending),
+                reached_end(other.reached_end) {}
+
+            record_view& operator=(record_view&& other) noexcept {
+                if (this != &other) {
+                    release();
+                    parent_reader = std::exchange(other.parent_reader, nullptr);
+                    current = std::move(other.current);
+                    pending = other.pending;
+                    reached_end = other.reached_end;
+                }
+                return *this;
+            }
+
+            ~record_view() {
+                release();
+            }
+
+            iterator begin() {
+                return iterator{ this };
+            }
+
+            std::default_sentinel_t end() const noexcept {
+                return std::default_sentinel;
+            }
+
+        private:
+            void fetch() {
+                if (!pending) { return; }
+                pending = false;
+                reached_end = reached_end || parent_reader == nullptr || !parent_reader->next(current);
+            }
+
+            void release() {
+                if (parent_reader != nullptr) { parent_reader->stream_pool.release(std::move(current)); }
+                parent_reader = nullptr;
+            }
+        };
+
+        /**
+         * @brief Returns a lazy view over the records that are not yet read. Records are not retained by the reader
+         * 
+         * @return record_view view of records 
+         */
+        record_view record_range() {
+            return record_view{ *this };
+        }
+
         /**
          * @brief Iterator support for range-based for loops
          * 
@@ -152,6 +356,141 @@ namespace turbo_csv {
             
         }
 
+        /**
+         * @brief Sets how malformed records are handled from now on. If the reader has a header and no
+         * expected field count is given, records are expected to have as many fields as the header
+         * 
+         * @param options validation options ( see parse_options )
+         */
+        void set_parse_options(parse_options options){
+            if(treat_first_record_as_header&&options.expected_field_count==0&&!records.empty()){
+                options.expected_field_count=records.front().get_field_count();
+            }
+            csv_parser.set_options(std::move(options));
+        }
+
+        /**
+         * @brief Enables utf-8 validation of the file from the current position onwards ( the header is already
+         * read by then ). Only available for file readers validating their buffers ( eg. file_reader )
+         * 
+         * @param options what to do with invalid sequences ( see utf8_options )
+         */
+        void set_utf8_options(utf8_options options) requires requires(FileReader& file_reader){file_reader.set_utf8_options(options);} {
+            csv_parser.get_file_reader().set_utf8_options(std::move(options));
+        }
+
+        /**
+         * @brief Returns the byte offset of the first invalid utf-8 sequence found so far
+         * 
+         * @return std::optional<std::uint64_t> offset/nullopt if no invalid sequence was found
+         */
+        std::optional<std::uint64_t> get_first_invalid_utf8_offset() requires requires(FileReader& file_reader){file_reader.get_first_invalid_utf8_offset();} {
+            return csv_parser.get_file_reader().get_first_invalid_utf8_offset();
+        }
+
+        /**
+         * @brief Returns a snapshot of the statistics of the reading pipeline. Counters of the parser and
+         * file reader are only collected if the file reader collects statistics ( eg. stats_reader ), they compile
+         * away otherwise
+         * 
+         * @return pipeline_stats snapshot of the statistics ( see pipeline_stats::to_json for exporting it )
+         */
+        pipeline_stats get_stats(){
+            pipeline_stats stats;
+            csv_parser.collect_stats(stats);
+            stats.deque_size=records.size();
+            stats.elapsed_seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-created_at).count();
+            return stats;
+        }
+
+        /**
+         * @brief Returns the position after the last record read by the reader. Reading can be resumed
+         * from it later on using open_at
+         * 
+         * @return parser_checkpoint byte offset of the next record along with the quote state
+         */
+        parser_checkpoint checkpoint(){
+            return csv_parser.checkpoint();
+        }
+
+        /**
+         * @brief Resumes reading from a checkpoint. Records cached by the reader are dropped (except the header)
+         * 
+         * @param position checkpoint returned by checkpoint()
+         */
+        void open_at(const parser_checkpoint& position){
+            drop_records();
+            stop_zone_map();
+            csv_parser.open_at(position);
+        }
+
+        /**
+         * @brief Resumes reading from the first record boundary at or after an arbitrary byte offset.
+         * Records cached by the reader are dropped (except the header)
+         * 
+         * @param offset arbitrary byte offset in the file
+         * @param expected_field_count number of fields per record (0 if unknown) used to detect the quote state
+         * @return std::uint64_t byte offset of the record from which reading resumes
+         */
+        std::uint64_t resync(std::uint64_t offset,std::size_t expected_field_count=0){
+            drop_records();
+            stop_zone_map();
+            return csv_parser.resync(offset,expected_field_count);
+        }
+
+        /**
+         * @brief Starts building a zone map ( per block min/max and null counts of every column ) out of the records
+         * read from now on, whichever way they are read. Recording stops when the reader is repositioned
+         * ( open_at, resync )
+         * 
+         * @param records_per_block number of records summarized by a block
+         */
+        void record_zone_map(std::uint64_t records_per_block=zone_map::default_records_per_block){
+            recorded_zones=std::make_unique<zone_map>(records_per_block,csv_parser.checkpoint());
+            recording_zones=true;
+        }
+
+        /**
+         * @brief Returns the zone map recorded so far ( the block being built is closed first )
+         * 
+         * @return zone_map& recorded zone map
+         * @throw std::logic_error if record_zone_map was never called
+         */
+        zone_map& get_zone_map(){
+            if(!recorded_zones){throw std::logic_error("turbo_csv::basic_reader: no zone map is being recorded");}
+            recorded_zones->finish();
+            return *recorded_zones;
+        }
+
+        /**
+         * @brief Calls function with the remaining records of the blocks that may contain a record for which
+         * field[column] <op> value holds. Other blocks are skipped without being read. Records are not retained
+         * by the reader and the blocks are only pruned, so function still has to check the predicate itself
+         * 
+         * @param zones zone map of the file ( eg. zone_map::load(path) )
+         * @param column index of the filtered column
+         * @param op comparison of the filter
+         * @param value value compared with ( numbers compare numerically, strings in byte order )
+         * @param function called with every record of the matching blocks
+         * @return std::uint64_t number of blocks read
+         */
+        template<typename Value,typename Function>
+        std::uint64_t for_each_matching(const zone_map& zones,std::size_t column,zone_op op,const Value& value,Function function){
+            auto record=stream_pool.acquire();
+            std::uint64_t blocks_read=0;
+            for(const auto& block:zones.get_blocks()){
+                if(!block.may_match(column,op,value)){continue;}
+                // Consecutive matching blocks are read without seeking
+                if(csv_parser.checkpoint().offset!=block.begin.offset){open_at(block.begin);}
+                for(std::uint64_t count=0;count<block.record_count&&next(record);count++){
+                    function(record);
+                }
+                blocks_read++;
+            }
+            stream_pool.release(std::move(record));
+            return blocks_read;
+        }
+
         /**
          * @brief Gets the total number of records in a csv file
          * 
@@ -190,23 +529,100 @@ namespace turbo_csv {
             int offset=0;
             if(treat_first_record_as_header){offset=1;}
 
-            std::vector<std::future<T>> deserialized_fields;
+            // Records are deserialized in one chunk per worker thread ( placed by the thread placement )
+            auto header_count=std::min<std::size_t>(offset,records.size());
+            auto record_count=records.size()-header_count;
+            auto chunk_count=std::clamp<std::size_t>(std::thread::hardware_concurrency(),1,std::max<std::size_t>(record_count,1));
+            std::vector<std::future<std::vector<T>>> deserialized_chunks;
             std::vector<T>column_items;
 
-            for(auto& rec: boost::make_iterator_range(records.begin()+offset,records.end())){
-                deserialized_fields.push_back(std::async([&rec,column_index](){return rec. template get_field<T>(column_index,true,true);}));
+            auto first_record=records.begin()+static_cast<std::ptrdiff_t>(header_count);
+            for(std::size_t chunk=0;chunk<chunk_count;chunk++){
+                auto chunk_begin=first_record+static_cast<std::ptrdiff_t>(record_count*chunk/chunk_count);
+                auto chunk_end=first_record+static_cast<std::ptrdiff_t>(record_count*(chunk+1)/chunk_count);
+                deserialized_chunks.push_back(std::async(std::launch::async,[chunk,chunk_begin,chunk_end,column_index](){
+                    placement::place_worker(chunk);
+                    std::vector<T> chunk_items;
+                    chunk_items.reserve(static_cast<std::size_t>(chunk_end-chunk_begin));
+                    for(auto& rec: boost::make_iterator_range(chunk_begin,chunk_end)){
+                        chunk_items.push_back(rec. template get_field<T>(column_index,true,true));
+                    }
+                    return chunk_items;
+                }));
             }
 
-            column_items.reserve(records.size());
+            column_items.reserve(record_count);
 
-            for(auto& deserialized_field:deserialized_fields){
-                column_items.push_back(deserialized_field.get());
+            for(auto& deserialized_chunk:deserialized_chunks){
+                for(auto& item: deserialized_chunk.get()){column_items.push_back(std::move(item));}
             }
 
             return column_items;
 
         }
 
+        /**
+         * @brief Calls a function on the remaining records from several threads. Records are parsed on the calling
+         * thread and handed out in batches to a work stealing pool, they are not retained by the reader and the
+         * function may be called concurrently ( in no particular order )
+         * 
+         * @param function callable void(basic_record<Dialect>&) or void(std::vector<basic_record<Dialect>>&)
+         * @param options number of threads, batch size and the number of parsed batches after which parsing blocks
+         * @throw Rethrows the first exception thrown by the function or the parser
+         */
+        template<typename Function>
+        void for_each_parallel(Function function,const parallel_options& options){
+            using record_batch=std::vector<basic_record<Dialect>>;
+            process_batches<Dialect>([this](basic_record<Dialect>& record){return next(record);},options,
+                [&function](std::size_t,record_batch& batch){
+                    if constexpr(std::is_invocable_v<Function&,basic_record<Dialect>&>){
+                        for(auto& record: batch){function(record);}
+                    }
+                    else{
+                        function(batch);
+                    }
+                });
+        }
+
+        template<typename Function>
+        void for_each_parallel(Function function,std::size_t thread_count=std::thread::hardware_concurrency()){
+            parallel_options options;
+            options.thread_count=thread_count;
+            for_each_parallel(std::move(function),options);
+        }
+
+        /**
+         * @brief Calls a function on the remaining records from several threads, every thread accumulating into its
+         * own copy of a state. The states are combined on the calling thread once all records are processed
+         * 
+         * @param initial state every thread starts from ( neutral for combine, eg. 0 for a sum )
+         * @param function callable void(State&,basic_record<Dialect>&) or void(State&,std::vector<basic_record<Dialect>>&)
+         * @param combine callable void(State& combined,State&& partial) folding the state of a thread into the result
+         * @param options number of threads, batch size and the number of parsed batches after which parsing blocks
+         * @return State states of the threads combined in thread order
+         * @throw Rethrows the first exception thrown by the function or the parser
+         */
+        template<typename State,typename Function,typename Combine>
+        State for_each_parallel(State initial,Function function,Combine combine,const parallel_options& options={}){
+            using record_batch=std::vector<basic_record<Dialect>>;
+            std::vector<State> states(std::max<std::size_t>(options.thread_count,1),initial);
+
+            process_batches<Dialect>([this](basic_record<Dialect>& record){return next(record);},options,
+                [&function,&states](std::size_t worker_index,record_batch& batch){
+                    auto& state=states[worker_index];
+                    if constexpr(std::is_invocable_v<Function&,State&,basic_record<Dialect>&>){
+                        for(auto& record: batch){function(state,record);}
+                    }
+                    else{
+                        function(state,batch);
+                    }
+                });
+
+            auto combined=std::move(states.front());
+            for(std::size_t i=1;i<states.size();i++){combine(combined,std::move(states[i]));}
+            return combined;
+        }
+
         /**
          * @brief Returns the index of the associated column
          * 
@@ -221,6 +637,19 @@ namespace turbo_csv {
 
     private:
 
+        void stop_zone_map(){
+            if(recording_zones){recorded_zones->finish();}
+            recording_zones=false;
+        }
+
+        void drop_records(){
+            std::size_t kept_records= treat_first_record_as_header&&!records.empty() ? 1 : 0;
+            while(records.size()>kept_records){
+                stream_pool.release(std::move(records.back()));
+                records.pop_back();
+            }
+        }
+
         void index_first_record(){
             std::size_t index=0;
             for(auto& field: records.front().get_fields()){
@@ -231,13 +660,16 @@ namespace turbo_csv {
 
         bool read_next_record() {
 
-            auto next_record= csv_parser.next();
+            // Parse straight into the deque slot instead of copying a finished record into it
+            records.emplace_back(stream_pool.acquire());
 
-            if(!next_record.is_empty()){
-                records.push_back(next_record);
+            if(csv_parser.next(records.back())){
+                if(recording_zones){recorded_zones->add(records.back(),csv_parser.checkpoint());}
                 return true;
             }
 
+            stream_pool.release(std::move(records.back()));
+            records.pop_back();
             return false;
         }
 
@@ -245,6 +677,8 @@ namespace turbo_csv {
 
     using reader=basic_reader<parser,adapted_fstream,dialect>;
     using experimental_reader=basic_reader<parser,file_reader<1000000>,dialect>;
+    using stats_reader=basic_reader<parser,stats_adapted_fstream,dialect>;
+    using stats_experimental_reader=basic_reader<parser,stats_file_reader<1000000>,dialect>;
 }
 
 
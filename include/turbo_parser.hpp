@@ -1,13 +1,118 @@
 #ifndef TURBO_PARSER_HPP
 #define TURBO_PARSER_HPP
 
+#include<string>
+#include<optional>
+#include<functional>
 #include<record.hpp>
+#include<dialect.hpp>
+#include<pipeline_stats.hpp>
+#include<simd_scan.hpp>
 
 namespace turbo_csv{
+
+    /**
+     * @brief What the parser does with malformed records
+     * 
+     * ignore : records are not validated at all (fastest, default)
+     * report : malformed records are returned as they are and reported to the error handler
+     * skip   : malformed records are reported and dropped
+     * repair : malformed records are reported and fixed. Stray quotes are treated as normal characters,
+     *          an unbalanced quote is closed at the first record seperator following it and the field count
+     *          is padded with empty fields/truncated to the expected count
+     */
+    enum class error_policy { ignore, report, skip, repair };
+
+    /**
+     * @brief Describes a malformed record
+     * 
+     * kind   : what is wrong with the record
+     * offset : byte offset of the beginning of the record in the file
+     * line   : line number (1 based, counted from where parsing started) on which the record begins
+     */
+    struct parse_error{
+        enum class error_kind { unbalanced_quote, stray_quote, field_count_mismatch };
+
+        error_kind kind;
+        std::uint64_t offset;
+        std::uint64_t line;
+        std::size_t field_count;
+        std::size_t expected_field_count;
+    };
+
+    /**
+     * @brief Options controlling the validation of records
+     * 
+     * policy               : what to do with malformed records
+     * expected_field_count : number of fields in every record (0 means the count of the first record parsed)
+     * max_record_size      : records growing larger than this while inside quotes are treated as having an
+     *                        unbalanced quote (0 means unlimited)
+     * on_error             : called for every malformed record (only invoked on the slow path)
+     * strip_bom            : a utf-8 byte order mark at the beginning of the file is not part of the first record
+     */
+    struct parse_options{
+        error_policy policy=error_policy::ignore;
+        std::size_t expected_field_count=0;
+        std::size_t max_record_size=0;
+        std::function<void(const parse_error&)> on_error;
+        bool strip_bom=true;
+    };
+
+    /**
+     * @brief Position from which parsing can be resumed
+     * 
+     * offset    : byte offset of the next record in the file
+     * in_quotes : the last record ended inside quotes (unbalanced escape character at end of file), hence
+     *             offset is not a real record boundary
+     */
+    struct parser_checkpoint{
+        std::uint64_t offset=0;
+        bool in_quotes=false;
+    };
+
     template<typename FileReader, typename Dialect>
     class parser{
         // Handles the disk reading part
         FileReader file_reader;
+
+        // Byte offset of the next byte read from the file reader
+        std::uint64_t current_offset=0;
+        bool last_record_in_quotes=false;
+
+        parse_options options;
+        std::uint64_t current_line=1;
+
+        // Bytes handed back to the parser after an unbalanced quote was closed. They are parsed again before
+        // reading further from the file reader
+        std::string pending_bytes;
+        std::size_t pending_position=0;
+
+        // Information collected by the validating fast path about the record being parsed
+        struct record_state{
+            std::uint64_t offset;
+            std::uint64_t line;
+            std::size_t field_count;
+            bool stray_quote;
+            bool unbalanced_quote;
+            // First record seperator found inside quotes. Bytes read after it are kept in suspect_bytes
+            // so that they can be parsed again if the quote turns out to be unbalanced
+            std::size_t quoted_seperator_position;
+            std::uint64_t quoted_seperator_line;
+            std::string suspect_bytes;
+        };
+        record_state state;
+
+        // Byte range of the file ( a file reader buffer ) the last pre-scan covered and whether it is free of
+        // escape and ignore characters (see parse_quote_free)
+        std::uint64_t scanned_begin=0;
+        std::uint64_t scanned_end=0;
+        bool scanned_quote_free=false;
+
+        // Parsing statistics are collected along with those of the file reader
+        static constexpr bool stats_enabled=collects_stats<FileReader>;
+        [[no_unique_address]] basic_stats_counter<stats_enabled> parsed_records;
+        [[no_unique_address]] basic_stats_counter<stats_enabled> parsed_fields;
+        [[no_unique_address]] basic_stats_counter<stats_enabled> buffer_growths;
         public:
 
         /**
@@ -24,38 +129,310 @@ namespace turbo_csv{
          */
         parser(FileReader& file_reader):file_reader(file_reader){}
 
+        /**
+         * @brief Returns the file reader used by the parser
+         * 
+         * @return FileReader& file reader from which the records are parsed
+         */
+        FileReader& get_file_reader(){
+            return file_reader;
+        }
+
+        /**
+         * @brief Returns the position after the last parsed record. Parsing can be resumed from it
+         * later on using open_at ( eg. by a new parser after a crash )
+         * 
+         * @return parser_checkpoint byte offset of the next record along with the quote state
+         */
+        parser_checkpoint checkpoint(){
+            return parser_checkpoint{current_offset-(pending_bytes.size()-pending_position),last_record_in_quotes};
+        }
+
+        /**
+         * @brief Adds the parsing statistics ( and those of the file reader if it collects any ) to the snapshot.
+         * All zero unless the file reader collects statistics ( see collects_stats )
+         * 
+         * @param stats snapshot to be filled
+         */
+        void collect_stats(pipeline_stats& stats){
+            stats.records=parsed_records.get();
+            stats.fields=parsed_fields.get();
+            stats.buffer_growths=buffer_growths.get();
+            if constexpr(requires{file_reader.collect_stats(stats);}){
+                file_reader.collect_stats(stats);
+            }
+        }
+
+        /**
+         * @brief Sets the options used to validate records from now on
+         * 
+         * @param new_options validation options
+         */
+        void set_options(parse_options new_options){
+            options=std::move(new_options);
+        }
+
+        /**
+         * @brief Returns the options used to validate records
+         * 
+         * @return const parse_options& validation options
+         */
+        const parse_options& get_options(){
+            return options;
+        }
+
+        /**
+         * @brief Resumes parsing from a record boundary obtained from checkpoint
+         * 
+         * @param offset byte offset of a record boundary
+         * @note FileReader must support seek(offset)
+         */
+        void open_at(std::uint64_t offset){
+            file_reader.seek(offset);
+            current_offset=offset;
+            last_record_in_quotes=false;
+            pending_bytes.clear();
+            pending_position=0;
+        }
+
+        /**
+         * @brief Resumes parsing from a checkpoint
+         * 
+         * @param position checkpoint returned by checkpoint()
+         */
+        void open_at(const parser_checkpoint& position){
+            open_at(position.offset);
+        }
+
+        /**
+         * @brief Resumes parsing from the first real record boundary at or after an arbitrary offset.
+         * As the quote state at offset is unknown, a window of bytes is scanned assuming both states and the
+         * one producing fewer inconsistencies (quotes not next to seperators, field counts differing from
+         * expected_field_count) is chosen
+         * 
+         * @param offset arbitrary byte offset in the file
+         * @param expected_field_count number of fields per record (0 if unknown)
+         * @param window_size number of bytes scanned to decide the quote state ( more are scanned if no record
+         * boundary is found in them )
+         * @return std::uint64_t byte offset of the record boundary from which parsing resumes ( the end of the
+         * file if no boundary follows offset )
+         */
+        std::uint64_t resync(std::uint64_t offset,std::size_t expected_field_count=0,std::size_t window_size=65536){
+            if(offset==0){
+                open_at(0);
+                return 0;
+            }
+
+            // Byte before offset is part of the window so that a boundary right at offset is found as well
+            auto window_begin=offset-1;
+            file_reader.seek(window_begin);
+            std::string window;
+            std::size_t target_size=std::max<std::size_t>(window_size,1);
+            std::size_t boundary=std::string::npos;
+            bool reached_end=false;
+            // A window without a record seperator in the chosen quote state ( eg. inside a field longer than the
+            // window ) is doubled until a boundary or the end of the file is found
+            while(true){
+                window.reserve(target_size);
+                while(window.size()<target_size){
+                    auto byte=file_reader.get_byte();
+                    if(!byte.has_value()){
+                        reached_end=true;
+                        break;
+                    }
+                    window.push_back(byte.value());
+                }
+
+                std::size_t outside_violations=0,inside_violations=0;
+                auto outside_boundary=find_boundary(window,false,expected_field_count,outside_violations);
+                auto inside_boundary=find_boundary(window,true,expected_field_count,inside_violations);
+                boundary= inside_violations<outside_violations ? inside_boundary : outside_boundary;
+                if(boundary!=std::string::npos||reached_end){break;}
+                target_size*=2;
+            }
+
+            auto resume_offset=window_begin+std::min(boundary,window.size());
+            open_at(resume_offset);
+            return resume_offset;
+        }
+
         /**
          * @brief Returns the next record from the file
          * 
          * @return basic_record<Dialect> Record containing the current csv row
          */
         basic_record<Dialect> next(){
+            basic_record<Dialect> record;
+            next(record);
+            return record;
+        }
+
+        /**
+         * @brief Refills the supplied record with the next record from the file
+         * 
+         * @param record Record to be refilled. Its buffers are reused so that no allocation happens
+         * once they have grown to the size of the largest row
+         * @return true A record was read into record
+         * @return false No more records are left in the file (record is left empty)
+         */
+        bool next(basic_record<Dialect>& record){
+            if(current_offset==0&&options.strip_bom){skip_bom();}
+
+            // Fast path: records are not validated at all
+            if(options.policy==error_policy::ignore&&pending_position==pending_bytes.size()){
+                return parse_record<false>(record);
+            }
+
+            while(true){
+                if(!parse_record<true>(record)){return false;}
+                // Only bytes handed back by skip_bom brought an unvalidated record here
+                if(options.policy==error_policy::ignore){return true;}
+                if(!state.stray_quote&&!state.unbalanced_quote&&field_count_matches()){return true;}
+
+                // Slow path: only taken for records that look malformed
+                if(handle_malformed(record)){return true;}
+            }
+        }
+
+        private:
+
+        // Reads the first bytes of the file. Bytes not forming a byte order mark are handed back to the parser
+        void skip_bom(){
+            constexpr unsigned char bom[3]={0xEF,0xBB,0xBF};
+            std::size_t matched=0;
+            while(matched<3){
+                auto byte=next_byte<false>();
+                if(!byte.has_value()){break;}
+                pending_bytes.push_back(static_cast<char>(byte.value()));
+                if(byte.value()!=bom[matched]){break;}
+                matched++;
+            }
+            if(matched==3){pending_bytes.clear();}
+            pending_position=0;
+        }
+
+        template<bool Validate>
+        std::optional<std::uint8_t> next_byte(){
+            if constexpr(Validate){
+                if(pending_position!=pending_bytes.size()){
+                    return static_cast<std::uint8_t>(pending_bytes[pending_position++]);
+                }
+            }
+            auto byte=file_reader.get_byte();
+            if(byte.has_value()){current_offset++;}
+            return byte;
+        }
+
+        template<bool Validate>
+        bool parse_record(basic_record<Dialect>& record){
+            if constexpr(stats_enabled){
+                auto capacity=record.raw_record.capacity();
+                auto escape_capacity=record.escape_char_pos.capacity();
+                bool parsed=parse_record_bytes<Validate>(record);
+                buffer_growths.add((record.raw_record.capacity()!=capacity)+(record.escape_char_pos.capacity()!=escape_capacity));
+                if(parsed){
+                    parsed_records.add();
+                    parsed_fields.add(count_fields(record));
+                }
+                return parsed;
+            }
+            else{
+                return parse_record_bytes<Validate>(record);
+            }
+        }
+
+        template<bool Validate>
+        bool parse_record_bytes(basic_record<Dialect>& record){
+
+            record.reset();
+
+            // Files without quotes are split without looking at every byte
+            using traits=dialect_traits<Dialect>;
+            if constexpr(!Validate&&traits::single_byte&&requires{file_reader.get_buffered();}){
+                if(auto parsed=parse_quote_free(record.raw_record)){return parsed.value();}
+            }
 
             // Represents the position of double quotes. This is used here as well as used in records
             // for parsing the record properly 
-            std::vector<int>escape_pos;
+            auto& escape_pos=record.escape_char_pos;
 
             // Raw string representation of record
-            std::string raw_record;
+            auto& raw_record=record.raw_record;
+
+            // Multi byte seperators are matched at the end of raw record once their last byte is read. Bytes
+            // before match_floor (escaped characters, an already matched seperator) can not be part of a match
+            [[maybe_unused]] std::size_t match_floor=0;
+
+            // Whether the last byte of the record is a recorded quote ( bytes escaped by the quote escape character
+            // of the dialect are normal characters even when they are quotes )
+            [[maybe_unused]] auto ends_with_quote=[&](){
+                return !escape_pos.empty()&&escape_pos.back()==raw_record.size()-1;
+            };
+
+            if constexpr(Validate){
+                state.offset=checkpoint().offset;
+                state.line=current_line;
+                state.field_count=1;
+                state.stray_quote=false;
+                state.unbalanced_quote=false;
+                state.quoted_seperator_position=std::string::npos;
+                state.suspect_bytes.clear();
+            }
 
             while (true) {
                 
-                auto byte = file_reader.get_byte();
+                auto byte = next_byte<Validate>();
 
                 // We are trying to read records even after reaching end of file
-                if (!byte.has_value() && raw_record.empty()) { return basic_record<Dialect>(); }
-
-                //We are at the last record ( it is not seperated by record seperator)
+                // or we are at the last record ( it is not seperated by record seperator)
                 if (!byte.has_value()) {
-                    return basic_record<Dialect>(raw_record,escape_pos);
+                    last_record_in_quotes = escape_pos.size() % 2 != 0;
+                    if constexpr(Validate){ state.unbalanced_quote=last_record_in_quotes; }
+                    return !raw_record.empty();
+                }
+
+                if constexpr(Validate){
+                    if(state.quoted_seperator_position!=std::string::npos){
+                        state.suspect_bytes.push_back(byte.value());
+                        if(options.max_record_size!=0&&raw_record.size()>options.max_record_size&&escape_pos.size()%2!=0){
+                            state.unbalanced_quote=true;
+                            return true;
+                        }
+                    }
+                }
+
+                // The character following a quote escape character is a normal character whatever it is
+                if constexpr(traits::has_quoteescape){
+                    if(traits::is_quoteescape(byte.value())){
+                        raw_record.push_back(byte.value());
+                        auto escaped_byte=next_byte<Validate>();
+                        if(!escaped_byte.has_value()){continue;}
+                        if constexpr(Validate){
+                            if(state.quoted_seperator_position!=std::string::npos){state.suspect_bytes.push_back(escaped_byte.value());}
+                        }
+                        raw_record.push_back(escaped_byte.value());
+                        match_floor=raw_record.size();
+                        continue;
+                    }
                 }
 
                 // If the current byte is an espace character push it simply but 
                 // note down its position as well. This will be useful later for
                 // record to find membership of a seperator in log(logN)
                 if (Dialect::is_escapecharacter(byte.value())) {
+                    if constexpr(Validate){
+                        // Opening quotes must begin a field. A stray one is kept as a normal character so that
+                        // it does not swallow the following records. Closing quotes are checked at the next byte
+                        bool opening=escape_pos.size()%2==0;
+                        if(options.policy!=error_policy::ignore&&opening&&!raw_record.empty()&&!traits::fieldseperator_before(raw_record,raw_record.size())&&!ends_with_quote()){
+                            state.stray_quote=true;
+                            raw_record.push_back(byte.value());
+                            continue;
+                        }
+                    }
+                    // Position is relative to the record ( ignore characters are not part of raw record )
+                    escape_pos.push_back(raw_record.size());
                     raw_record.push_back(byte.value());
-                    escape_pos.push_back(file_reader.get_current_readcount() - 1); // 0 based
                 }
 
                 // If the current byte is a record seperator example (\n,\r)
@@ -64,18 +441,25 @@ namespace turbo_csv{
                 // pos tells the number of escape_chars read. If those are 'even' it simply means
                 // we are at the end of a csv record so we just return it otherwise if odd then 
                 // the recordseperator is not a record seperator but a part of field of a csv record :)
-                else if (Dialect::is_recordseperator(byte.value())) {
+                else if (!traits::multibyte_recordseperator&&Dialect::is_recordseperator(byte.value())) {
+                    current_line++;
                     if (escape_pos.size() % 2 == 0) {
-                        return basic_record<Dialect>(raw_record, escape_pos);
+                        return !raw_record.empty();
                     }
                     else {
+                        if constexpr(Validate){
+                            if(state.quoted_seperator_position==std::string::npos){
+                                state.quoted_seperator_position=raw_record.size();
+                                state.quoted_seperator_line=current_line;
+                            }
+                        }
                         raw_record.push_back(byte.value());
                     }
                 }
 
                 // Store the ignore characters(line feed, carriage return) if it belongs to the membership of
                 //  escape set otherwise simply dump we dont need them
-                else if(dialect::is_ignorecharacter(byte.value())){
+                else if(Dialect::is_ignorecharacter(byte.value())){
                     if(escape_pos.size()%2!=0){
                         raw_record.push_back(byte.value());
                     }
@@ -83,9 +467,264 @@ namespace turbo_csv{
 
                 // Normal character [a-z][0-9][everything not present in dialect set]
                 else {
+                    if constexpr(Validate){
+                        bool inside_quotes=escape_pos.size()%2!=0;
+                        if(!inside_quotes&&Dialect::is_fieldseperator(byte.value())){
+                            if constexpr(!traits::multibyte_fieldseperator){state.field_count++;}
+                        }
+                        // A closing quote must be followed by a seperator (or another quote)
+                        else if(!inside_quotes&&ends_with_quote()&&!Dialect::is_recordseperator(byte.value())){
+                            state.stray_quote=true;
+                        }
+                    }
                     raw_record.push_back(byte.value());
+
+                    if constexpr(traits::multibyte_fieldseperator&&Validate){
+                        auto seperator_size=traits::fieldseperator_size();
+                        if(escape_pos.size()%2==0&&raw_record.size()>=match_floor+seperator_size&&traits::fieldseperator_before(raw_record,raw_record.size())){
+                            state.field_count++;
+                            match_floor=raw_record.size();
+                        }
+                    }
+
+                    if constexpr(traits::multibyte_recordseperator){
+                        auto seperator_size=traits::recordseperator_size();
+                        if(raw_record.size()>=match_floor+seperator_size&&traits::ends_with_recordseperator(raw_record)){
+                            current_line++;
+                            if(escape_pos.size()%2==0){
+                                raw_record.resize(raw_record.size()-seperator_size);
+                                return !raw_record.empty();
+                            }
+                            if constexpr(Validate){
+                                if(state.quoted_seperator_position==std::string::npos){
+                                    state.quoted_seperator_position=raw_record.size()-seperator_size;
+                                    state.quoted_seperator_line=current_line;
+                                }
+                            }
+                            match_floor=raw_record.size();
+                        }
+                    }
+                }
+            }
+        }
+
+        // Adaptive fast path for buffered file readers. Every buffer is pre-scanned once for escape and ignore
+        // characters. As long as there are none, records are cut at the record seperators found 16 bytes at a time
+        // and copied as a whole, without any quote tracking. Returns nullopt as soon as the buffer holding the rest
+        // of the record contains one of them, the byte loop then continues the record (bytes consumed so far are
+        // already in raw_record and hold no quotes)
+        std::optional<bool> parse_quote_free(std::string& raw_record){
+            while(true){
+                auto buffered=file_reader.get_buffered();
+                if(buffered.empty()){
+                    last_record_in_quotes=false;
+                    return !raw_record.empty();
+                }
+
+                auto buffer_end_offset=current_offset+buffered.size();
+                if(current_offset<scanned_begin||buffer_end_offset!=scanned_end){
+                    scanned_begin=current_offset;
+                    scanned_end=buffer_end_offset;
+                    scanned_quote_free=is_quote_free(buffered);
+                }
+                if(!scanned_quote_free){return {};}
+
+                const char* begin=buffered.data();
+                const char* end=begin+buffered.size();
+                const char* seperator=simd::find_first_of(begin,end,Dialect::get_recordseperator());
+                raw_record.append(begin,seperator);
+
+                auto consumed=static_cast<std::size_t>(seperator-begin)+(seperator!=end);
+                file_reader.skip_buffered(consumed);
+                current_offset+=consumed;
+                if(seperator!=end){
+                    current_line++;
+                    return !raw_record.empty();
+                }
+            }
+        }
+
+        static bool is_quote_free(std::string_view buffered){
+            const char* begin=buffered.data();
+            const char* end=begin+buffered.size();
+            if(simd::contains_any_of(begin,end,Dialect::get_escapecharacter())){return false;}
+            for(auto ignore_character:Dialect::get_ignore_characters()){
+                if(simd::contains_any_of(begin,end,ignore_character)){return false;}
+            }
+            return true;
+        }
+
+        bool field_count_matches(){
+            if(options.expected_field_count==0){
+                options.expected_field_count=state.field_count;
+                return true;
+            }
+            return state.field_count==options.expected_field_count;
+        }
+
+        // Returns true if the record is to be handed out, false if it is dropped
+        bool handle_malformed(basic_record<Dialect>& record){
+            parse_error error;
+            error.offset=state.offset;
+            error.line=state.line;
+            error.expected_field_count=options.expected_field_count;
+            error.kind= state.unbalanced_quote ? parse_error::error_kind::unbalanced_quote :
+                state.stray_quote ? parse_error::error_kind::stray_quote : parse_error::error_kind::field_count_mismatch;
+
+            // Everything after the first quoted record seperator belongs to the following records
+            if(state.unbalanced_quote&&state.quoted_seperator_position!=std::string::npos){
+                auto cut_position=state.quoted_seperator_position;
+                auto& positions=record.escape_char_pos;
+                record.raw_record.resize(cut_position);
+                while(!positions.empty()&&positions.back()>=cut_position){positions.pop_back();}
+                reinject_suspect_bytes();
+            }
+
+            if(options.policy==error_policy::repair){
+                rebuild_escape_positions(record);
+                fix_field_count(record);
+            }
+            error.field_count=count_fields(record);
+
+            if(options.on_error){options.on_error(error);}
+
+            return options.policy!=error_policy::skip;
+        }
+
+        void reinject_suspect_bytes(){
+            // Unparsed pending bytes (if any) come after the suspect ones
+            state.suspect_bytes.append(pending_bytes,pending_position,std::string::npos);
+            std::swap(pending_bytes,state.suspect_bytes);
+            pending_position=0;
+            current_line=state.quoted_seperator_line;
+            last_record_in_quotes=false;
+        }
+
+        // Recomputes the quote positions (record relative) so that only quotes enclosing a complete field are
+        // treated as escape characters. Every other quote is a normal character
+        void rebuild_escape_positions(basic_record<Dialect>& record){
+            auto& raw=record.raw_record;
+            auto& positions=record.escape_char_pos;
+            positions.clear();
+
+            bool in_quotes=false;
+            std::size_t open_position=0;
+            using traits=dialect_traits<Dialect>;
+            for(std::size_t i=0;i<raw.size();i++){
+                if(traits::is_quoteescape(raw[i])){i++;continue;}
+                if(!Dialect::is_escapecharacter(raw[i])){continue;}
+                bool field_begin= i==0||traits::fieldseperator_before(raw,i);
+                if(!in_quotes){
+                    if(field_begin){
+                        in_quotes=true;
+                        open_position=positions.size();
+                        positions.push_back(i);
+                    }
+                }
+                else if(i+1<raw.size()&&Dialect::is_escapecharacter(raw[i+1])){
+                    // Doubled quote inside a quoted field
+                    positions.push_back(i);
+                    positions.push_back(i+1);
+                    i++;
+                }
+                else if(i+1==raw.size()||traits::fieldseperator_at(raw,i+1)){
+                    in_quotes=false;
+                    positions.push_back(i);
+                }
+            }
+            // A quote that is never closed is a normal character
+            if(in_quotes){positions.truncate(open_position);}
+        }
+
+        std::size_t count_fields(basic_record<Dialect>& record){
+            std::size_t field_count=1;
+            auto& raw=record.raw_record;
+            std::size_t quotes_seen=0;
+            auto& positions=record.escape_char_pos;
+            using traits=dialect_traits<Dialect>;
+            for(std::size_t i=0;i<raw.size();i++){
+                if(traits::is_quoteescape(raw[i])){i++;continue;}
+                while(quotes_seen<positions.size()&&positions[quotes_seen]<i){quotes_seen++;}
+                if(quotes_seen%2==0&&traits::fieldseperator_at(raw,i)){
+                    field_count++;
+                    i+=traits::fieldseperator_size()-1;
+                }
+            }
+            return field_count;
+        }
+
+        void fix_field_count(basic_record<Dialect>& record){
+            auto expected=options.expected_field_count;
+            if(expected==0){return;}
+
+            auto field_count=count_fields(record);
+            auto& raw=record.raw_record;
+            using traits=dialect_traits<Dialect>;
+            if(field_count<expected){
+                for(;field_count<expected;field_count++){
+                    if constexpr(traits::multibyte_fieldseperator){raw.append(Dialect::get_fieldseperator_sequence());}
+                    else{raw.push_back(Dialect::get_fieldseperator());}
+                }
+                return;
+            }
+            if(field_count>expected){
+                // Cut the record at the seperator beginning the first extra field
+                std::size_t seperators=0,quotes_seen=0;
+                auto& positions=record.escape_char_pos;
+                for(std::size_t i=0;i<raw.size();i++){
+                    if(traits::is_quoteescape(raw[i])){i++;continue;}
+                    while(quotes_seen<positions.size()&&positions[quotes_seen]<i){quotes_seen++;}
+                    if(quotes_seen%2!=0||!traits::fieldseperator_at(raw,i)){continue;}
+                    if(++seperators==expected){
+                        raw.resize(i);
+                        while(!positions.empty()&&positions.back()>=i){positions.pop_back();}
+                        return;
+                    }
+                    i+=traits::fieldseperator_size()-1;
+                }
+            }
+        }
+
+        // Returns the position after the first record seperator found outside quotes when the window starts
+        // in the given quote state. Every inconsistency with that assumption is counted in violations
+        std::size_t find_boundary(const std::string& window,bool in_quotes,std::size_t expected_field_count,std::size_t& violations){
+            auto is_delimiter=[](char character){
+                return Dialect::is_fieldseperator(character)||Dialect::is_recordseperator(character)||
+                    Dialect::is_ignorecharacter(character)||character==' '||character=='\r';
+            };
+
+            using traits=dialect_traits<Dialect>;
+            std::size_t boundary=std::string::npos;
+            std::size_t field_count=1;
+            for(std::size_t i=0;i<window.size();i++){
+                auto character=window[i];
+                if(traits::is_quoteescape(character)){
+                    i++;
+                }
+                else if(Dialect::is_escapecharacter(character)){
+                    if(!in_quotes){
+                        // Opening quote must start a field (or follow a closing one for doubled quotes)
+                        if(i>0&&!is_delimiter(window[i-1])&&!Dialect::is_escapecharacter(window[i-1])){violations++;}
+                    }
+                    else{
+                        // Closing quote must end a field (or be followed by the second one of doubled quotes)
+                        if(i+1<window.size()&&!is_delimiter(window[i+1])&&!Dialect::is_escapecharacter(window[i+1])){violations++;}
+                    }
+                    in_quotes=!in_quotes;
+                }
+                else if(!in_quotes&&traits::fieldseperator_at(window,i)){
+                    field_count++;
+                    i+=traits::fieldseperator_size()-1;
+                }
+                else if(!in_quotes&&traits::recordseperator_at(window,i)){
+                    i+=traits::recordseperator_size()-1;
+                    // First record is partial, only the complete ones after it are checked
+                    if(boundary==std::string::npos){boundary=i+1;}
+                    else if(expected_field_count!=0&&field_count!=expected_field_count){violations++;}
+                    field_count=1;
                 }
             }
+            return boundary;
         }
 
 
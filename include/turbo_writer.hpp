@@ -0,0 +1,305 @@
+#ifndef TURBO_WRITER_HPP
+#define TURBO_WRITER_HPP
+
+#include<memory>
+#include<string>
+#include<tuple>
+#include<vector>
+#include<limits>
+#include<cstdio>
+#include<charconv>
+#include<string_view>
+#include<type_traits>
+#include<algorithm>
+#include<boost/lexical_cast.hpp>
+#include<record.hpp>
+#include<dialect.hpp>
+#include<file_sink.hpp>
+#include<simd_scan.hpp>
+
+namespace turbo_csv {
+    template<typename Dialect, typename Sink = file_sink>
+    class basic_writer {
+        Sink sink;
+
+        std::unique_ptr<char[]> buffer;
+        std::size_t buffer_size;
+        std::size_t used = 0;
+
+        // Whether a field has already been written to the current record ( needs a seperator before the next one )
+        bool record_started = false;
+
+        // Longest representation produced by std::to_chars for any arithmetic type
+        static constexpr std::size_t max_number_size = 64;
+
+    public:
+
+        /**
+         * @brief Construct a new basic writer object
+         *
+         * @param fp path of the csv file to be written
+         * @param buffer_size size of the output buffer. Data is handed to the sink in blocks of this size
+         */
+        basic_writer(const std::string& fp, std::size_t buffer_size = 1 << 20) :
+            sink(fp),
+            buffer(new char[std::max(buffer_size, 2 * max_number_size)]),
+            buffer_size(std::max(buffer_size, 2 * max_number_size)) {
+
+        }
+
+        basic_writer(const basic_writer&) = delete;
+        basic_writer& operator=(const basic_writer&) = delete;
+
+        ~basic_writer() {
+            try { flush(); }
+            catch (...) {}
+        }
+
+        /**
+         * @brief Appends a field to the current record. Strings are quoted if they contain a
+         * seperator or the escape character, numbers are formatted with std::to_chars
+         *
+         * @tparam T type of the field
+         * @param value value of the field
+         */
+        template<typename T>
+        void write_field(const T& value) {
+            if (record_started) {
+                put_fieldseperator();
+            }
+            record_started = true;
+            format(value);
+        }
+
+        /**
+         * @brief Terminates the current record
+         *
+         */
+        void end_record() {
+            if constexpr (dialect_traits<Dialect>::multibyte_recordseperator) {
+                auto seperator = Dialect::get_recordseperator_sequence();
+                append(seperator.data(), seperator.size());
+            }
+            else {
+                put(Dialect::get_recordseperator());
+            }
+            record_started = false;
+        }
+
+        /**
+         * @brief Writes a complete record from the supplied values
+         *
+         * @param values values of the fields (in order)
+         */
+        template<typename... Ts>
+        void write_record(const Ts&... values) {
+            (write_field(values), ...);
+            end_record();
+        }
+
+        /**
+         * @brief Writes a complete record from a tuple like object (std::tuple,std::pair,std::array)
+         *
+         * @param values tuple containing the values of the fields
+         */
+        template<typename Tuple>
+        void write_tuple(const Tuple& values) {
+            std::apply([this](const auto&... fields) {this->write_record(fields...);}, values);
+        }
+
+        /**
+         * @brief Writes a complete record from the given members of a struct
+         *
+         * @param object object to be written
+         * @param members pointers to the members to be written (in order) eg. &car::year,&car::brand
+         */
+        template<typename T, typename... Members>
+        void write_struct(const T& object, Members... members) {
+            write_record(object.*members...);
+        }
+
+        /**
+         * @brief Writes a columnar batch. Record i consists of the i'th value of every column
+         *
+         * @param columns columns of the batch ( the shortest column decides the number of records )
+         */
+        template<typename... Columns>
+        void write_columns(const Columns&... columns) {
+            std::size_t rows = std::min({ std::size(columns)... });
+            for (std::size_t row = 0; row < rows; row++) {
+                write_record(columns[row]...);
+            }
+        }
+
+        /**
+         * @brief Writes a record read by a reader. Fields are written as they are in the source
+         * (already quoted fields are not quoted again)
+         *
+         * @param record record to be written
+         */
+        void write(basic_record<Dialect>& record) {
+            append_fields(record);
+            end_record();
+        }
+
+        /**
+         * @brief Appends the fields of a record read by a reader to the current record as they are in the source
+         * ( eg. to write records joined from several files )
+         *
+         * @param record record whose fields are appended
+         */
+        void append_fields(basic_record<Dialect>& record) {
+            for (auto& field : record.get_fields()) {
+                if (record_started) {
+                    put_fieldseperator();
+                }
+                record_started = true;
+                append(field.data(), field.size());
+            }
+        }
+
+        /**
+         * @brief Hands the buffered data over to the sink and flushes the sink
+         *
+         */
+        void flush() {
+            flush_buffer();
+            sink.flush();
+        }
+
+    private:
+
+        template<typename T>
+        void format(const T& value) {
+            if constexpr (std::is_same_v<T, bool>) {
+                put(value ? '1' : '0');
+            }
+            else if constexpr (std::is_same_v<T, char>) {
+                format(std::string_view(&value, 1));
+            }
+            else if constexpr (std::is_arithmetic_v<T>) {
+                if (buffer_size - used < max_number_size) { flush_buffer(); }
+#ifndef __cpp_lib_to_chars
+                // Floating point std::to_chars is missing before libstdc++ 11, the shortest round trip form is
+                // replaced by one with enough digits to round trip
+                if constexpr (std::is_floating_point_v<T>) {
+                    auto written = std::snprintf(buffer.get() + used, buffer_size - used, "%.*Lg",
+                        std::numeric_limits<T>::max_digits10, static_cast<long double>(value));
+                    used += static_cast<std::size_t>(std::max(written, 0));
+                }
+                else
+#endif
+                {
+                    auto result = std::to_chars(buffer.get() + used, buffer.get() + buffer_size, value);
+                    used = static_cast<std::size_t>(result.ptr - buffer.get());
+                }
+            }
+            else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                format_string(std::string_view(value));
+            }
+            else {
+                format_string(boost::lexical_cast<std::string>(value));
+            }
+        }
+
+        void format_string(std::string_view field) {
+            using traits = dialect_traits<Dialect>;
+            auto escape_character = Dialect::get_escapecharacter();
+            // First bytes of multi byte seperators are enough to decide, fields containing only them are quoted as well
+            const char* first_special;
+            if constexpr (traits::has_quoteescape) {
+                first_special = simd::find_first_of(field.data(), field.data() + field.size(),
+                    Dialect::get_fieldseperator(), Dialect::get_recordseperator(), escape_character, '\r', Dialect::get_quoteescape());
+            }
+            else {
+                first_special = simd::find_first_of(field.data(), field.data() + field.size(),
+                    Dialect::get_fieldseperator(), Dialect::get_recordseperator(), escape_character, '\r');
+            }
+            // The parser drops ignore characters outside quotes, fields containing them are quoted to keep them
+            if (first_special == field.data() + field.size()) {
+                const auto& ignore_characters = Dialect::get_ignore_characters();
+                if (!ignore_characters.empty() &&
+                    field.find_first_of(std::string_view(ignore_characters.data(), ignore_characters.size())) != std::string_view::npos) {
+                    first_special = field.data();
+                }
+            }
+
+            // Fast path: nothing in the field needs escaping
+            if (first_special == field.data() + field.size()) {
+                append(field.data(), field.size());
+                return;
+            }
+
+            // Quote the field and escape the escape characters inside it ( doubled, or prefixed with the quote
+            // escape character of the dialect )
+            put(escape_character);
+            auto begin = field.data();
+            auto end = field.data() + field.size();
+            while (true) {
+                const char* quote;
+                if constexpr (traits::has_quoteescape) {
+                    quote = simd::find_first_of(begin, end, escape_character, Dialect::get_quoteescape());
+                }
+                else {
+                    quote = simd::find_first_of(begin, end, escape_character);
+                }
+                if (quote == end) {
+                    append(begin, static_cast<std::size_t>(end - begin));
+                    break;
+                }
+                if constexpr (traits::has_quoteescape) {
+                    append(begin, static_cast<std::size_t>(quote - begin));
+                    put(Dialect::get_quoteescape());
+                    put(*quote);
+                }
+                else {
+                    append(begin, static_cast<std::size_t>(quote - begin) + 1);
+                    put(escape_character);
+                }
+                begin = quote + 1;
+            }
+            put(escape_character);
+        }
+
+        void put_fieldseperator() {
+            if constexpr (dialect_traits<Dialect>::multibyte_fieldseperator) {
+                auto seperator = Dialect::get_fieldseperator_sequence();
+                append(seperator.data(), seperator.size());
+            }
+            else {
+                put(Dialect::get_fieldseperator());
+            }
+        }
+
+        void put(char character) {
+            if (used == buffer_size) { flush_buffer(); }
+            buffer[used++] = character;
+        }
+
+        void append(const char* data, std::size_t size) {
+            if (size > buffer_size - used) {
+                flush_buffer();
+                // Too large to be buffered, hand it over directly
+                if (size >= buffer_size) {
+                    sink.write(data, size);
+                    return;
+                }
+            }
+            std::copy(data, data + size, buffer.get() + used);
+            used += size;
+        }
+
+        void flush_buffer() {
+            if (used != 0) {
+                sink.write(buffer.get(), used);
+                used = 0;
+            }
+        }
+
+    };
+
+    using writer = basic_writer<dialect, file_sink>;
+    using async_writer = basic_writer<dialect, async_file_sink>;
+}
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef UTF8_VALIDATOR_HPP
+#define UTF8_VALIDATOR_HPP
+
+#include<atomic>
+#include<algorithm>
+#include<cstring>
+#include<cstdint>
+#include<optional>
+#include<functional>
+#include<simd_scan.hpp>
+
+namespace turbo_csv {
+
+    /**
+     * @brief What the validator does with invalid utf-8 sequences
+     *
+     * report  : data is left as it is, invalid sequences are only reported
+     * replace : every byte of an invalid sequence is replaced with the replacement character ( a single
+     *           byte is used so that byte offsets into the file stay the same )
+     */
+    enum class utf8_action { report, replace };
+
+    /**
+     * @brief Options of the utf-8 validation stage
+     *
+     * action      : what to do with invalid sequences
+     * replacement : character written over invalid bytes ( utf8_action::replace )
+     * on_invalid  : called with the byte offset of every invalid sequence. It is invoked on the thread
+     *               filling the buffers ( producer thread of file_reader )
+     */
+    struct utf8_options {
+        utf8_action action = utf8_action::report;
+        char replacement = '?';
+        std::function<void(std::uint64_t)> on_invalid;
+    };
+
+    /**
+     * @brief Streaming utf-8 validator run over consecutive blocks of a file. Blocks of ascii are skipped
+     * 16 bytes at a time, only multibyte sequences are decoded byte by byte. A sequence split at the end of a
+     * block is held back and handed out at the beginning of the next block so that it can be replaced as a whole
+     *
+     */
+    class utf8_validator {
+        utf8_options options;
+
+        char carry[3];
+        std::size_t carry_size = 0;
+
+        // Read by the consumer while the producer validates
+        std::atomic<std::uint64_t> first_invalid = no_invalid_offset;
+        std::atomic<std::uint64_t> invalid_count = 0;
+
+        static constexpr std::uint64_t no_invalid_offset = ~std::uint64_t(0);
+
+    public:
+        utf8_validator(utf8_options options = {}) :options(std::move(options)) {}
+
+        /**
+         * @brief Returns the byte offset of the first invalid sequence found so far
+         *
+         * @return std::optional<std::uint64_t> offset/nullopt if everything validated so far is utf-8
+         */
+        std::optional<std::uint64_t> first_invalid_offset() const {
+            auto offset = first_invalid.load(std::memory_order_relaxed);
+            if (offset == no_invalid_offset) { return {}; }
+            return offset;
+        }
+
+        /**
+         * @brief Returns the number of invalid sequences found so far
+         *
+         * @return std::uint64_t
+         */
+        std::uint64_t invalid_sequences() const {
+            return invalid_count.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Copies the bytes held back from the previous block to the beginning of data
+         *
+         * @param data beginning of the next block ( at least 3 bytes long )
+         * @return std::size_t number of bytes copied
+         */
+        std::size_t restore_carry(char* data) noexcept {
+            std::memcpy(data, carry, carry_size);
+            auto restored = carry_size;
+            carry_size = 0;
+            return restored;
+        }
+
+        /**
+         * @brief Forgets the held back bytes ( eg. after seeking )
+         *
+         */
+        void reset() noexcept {
+            carry_size = 0;
+        }
+
+        /**
+         * @brief Validates a block ( replacing invalid bytes if requested )
+         *
+         * @param data beginning of the block
+         * @param size number of bytes in the block
+         * @param offset byte offset of the block in the file
+         * @param end_of_input no more blocks follow, an incomplete trailing sequence is invalid
+         * @return std::size_t number of bytes that can be handed out. The remaining ones ( an incomplete
+         * trailing sequence ) are held back until restore_carry is called
+         */
+        std::size_t process(char* data, std::size_t size, std::uint64_t offset, bool end_of_input) {
+            std::size_t i = 0;
+            while (i < size) {
+#ifdef TURBO_CSV_SSE2
+                if (size - i >= 16) {
+                    auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))));
+                    if (mask == 0) {
+                        i += 16;
+                        continue;
+                    }
+                    i += static_cast<std::size_t>(std::countr_zero(mask));
+                }
+#endif
+                auto lead = static_cast<unsigned char>(data[i]);
+                if (lead < 0x80) {
+                    i++;
+                    continue;
+                }
+
+                std::size_t length = 0;
+                unsigned char lower = 0x80, upper = 0xBF;
+                if (lead >= 0xC2 && lead <= 0xDF) { length = 2; }
+                else if (lead >= 0xE0 && lead <= 0xEF) {
+                    length = 3;
+                    if (lead == 0xE0) { lower = 0xA0; }     // Overlong encodings
+                    if (lead == 0xED) { upper = 0x9F; }     // Surrogates
+                }
+                else if (lead >= 0xF0 && lead <= 0xF4) {
+                    length = 4;
+                    if (lead == 0xF0) { lower = 0x90; }     // Overlong encodings
+                    if (lead == 0xF4) { upper = 0x8F; }     // Above U+10FFFF
+                }
+
+                // Number of bytes forming a valid ( possibly incomplete ) prefix of the sequence
+                std::size_t valid_prefix = length == 0 ? 0 : 1;
+                while (valid_prefix < length && i + valid_prefix < size) {
+                    auto continuation = static_cast<unsigned char>(data[i + valid_prefix]);
+                    if (valid_prefix == 1 ? (continuation < lower || continuation > upper) : (continuation & 0xC0) != 0x80) { break; }
+                    valid_prefix++;
+                }
+
+                if (length != 0 && valid_prefix == length) {
+                    i += length;
+                    continue;
+                }
+                if (length != 0 && i + valid_prefix == size && !end_of_input) {
+                    // Split at the end of the block, decided once the next block arrives
+                    carry_size = size - i;
+                    std::memcpy(carry, data + i, carry_size);
+                    return i;
+                }
+
+                auto invalid_bytes = std::max<std::size_t>(valid_prefix, 1);
+                report_invalid(offset + i);
+                if (options.action == utf8_action::replace) {
+                    std::memset(data + i, options.replacement, invalid_bytes);
+                }
+                i += invalid_bytes;
+            }
+            return size;
+        }
+
+    private:
+
+        void report_invalid(std::uint64_t offset) {
+            auto expected = no_invalid_offset;
+            first_invalid.compare_exchange_strong(expected, offset, std::memory_order_relaxed);
+            invalid_count.fetch_add(1, std::memory_order_relaxed);
+            if (options.on_invalid) { options.on_invalid(offset); }
+        }
+    };
+
+}
+
+#endif
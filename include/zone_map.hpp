@@ -0,0 +1,406 @@
+#ifndef ZONE_MAP_HPP
+#define ZONE_MAP_HPP
+
+#include<limits>
+#include<string>
+#include<vector>
+#include<cstdint>
+#include<fstream>
+#include<algorithm>
+#include<type_traits>
+#include<stdexcept>
+#include<filesystem>
+#include<string_view>
+#include<record.hpp>
+#include<field_utils.hpp>
+#include<turbo_parser.hpp>
+
+namespace turbo_csv {
+
+    /**
+     * @brief Comparison of a filtered read ( field <op> value )
+     *
+     */
+    enum class zone_op { less, less_equal, equal, greater_equal, greater };
+
+    /**
+     * @brief Statistics of one column inside a block of records
+     *
+     * null_count  : fields that are empty ( after trimming spaces and quotes ) or missing from the record
+     * value_count : fields that are not null
+     * min/max     : smallest/largest value in byte order
+     * numeric     : every value is a number, numeric_min/numeric_max hold the smallest/largest one
+     */
+    struct zone_column_stats {
+        std::uint64_t null_count = 0;
+        std::uint64_t value_count = 0;
+        std::string min;
+        std::string max;
+        bool numeric = true;
+        double numeric_min = std::numeric_limits<double>::infinity();
+        double numeric_max = -std::numeric_limits<double>::infinity();
+
+        void add(std::string_view value) {
+            if (value.empty()) {
+                null_count++;
+                return;
+            }
+            if (value_count == 0 || value < min) { min.assign(value); }
+            if (value_count == 0 || value > max) { max.assign(value); }
+            value_count++;
+
+            double number;
+            if (numeric && parse_number(value, number)) {
+                numeric_min = std::min(numeric_min, number);
+                numeric_max = std::max(numeric_max, number);
+            }
+            else {
+                numeric = false;
+            }
+        }
+
+        /**
+         * @brief Checks whether a value of the column may satisfy the comparison
+         *
+         * @return false no value of the block satisfies it, the block can be skipped
+         */
+        bool may_match(zone_op op, double value) const {
+            if (value_count == 0) { return false; }
+            // Byte order of non numeric columns says nothing about numeric comparisons
+            if (!numeric) { return true; }
+            return in_range(op, numeric_min, numeric_max, value);
+        }
+
+        bool may_match(zone_op op, std::string_view value) const {
+            if (value_count == 0) { return false; }
+            return in_range(op, std::string_view(min), std::string_view(max), value);
+        }
+
+    private:
+        template<typename T>
+        static bool in_range(zone_op op, const T& min, const T& max, const T& value) {
+            switch (op) {
+            case zone_op::less: return min < value;
+            case zone_op::less_equal: return min <= value;
+            case zone_op::equal: return min <= value && value <= max;
+            case zone_op::greater_equal: return max >= value;
+            case zone_op::greater: return max > value;
+            }
+            return true;
+        }
+    };
+
+    /**
+     * @brief Block of consecutive records along with the statistics of its columns
+     *
+     * begin        : position of the first record of the block ( usable with open_at )
+     * end_offset   : byte offset right after the last record of the block
+     * first_record : index of the first record of the block ( counted from where recording started )
+     * record_count : number of records in the block
+     */
+    struct zone_block {
+        parser_checkpoint begin;
+        std::uint64_t end_offset = 0;
+        std::uint64_t first_record = 0;
+        std::uint64_t record_count = 0;
+        std::vector<zone_column_stats> columns;
+
+        /**
+         * @brief Checks whether a record of the block may satisfy column <op> value
+         *
+         * @return false the block can be skipped without parsing it
+         */
+        template<typename Value>
+        bool may_match(std::size_t column, zone_op op, const Value& value) const {
+            if (column >= columns.size()) { return false; }
+            if constexpr (std::is_arithmetic_v<Value>) {
+                return columns[column].may_match(op, static_cast<double>(value));
+            }
+            else {
+                return columns[column].may_match(op, std::string_view(value));
+            }
+        }
+    };
+
+    /**
+     * @brief Per block min/max and null counts of every column of a csv file ( a zone map ). Blocks whose
+     * statistics rule out a filter are skipped by basic_reader::for_each_matching without being parsed.
+     * It is built while a basic_reader reads the file ( see basic_reader::record_zone_map ) and saved in a
+     * sidecar file next to the csv file
+     *
+     */
+    class zone_map {
+        std::uint64_t records_per_block;
+
+        // Identity of the csv file the zone map was saved for : size, modification time and a hash of its first
+        // and last fingerprint_size bytes
+        std::uint64_t file_size = 0;
+        std::int64_t file_time = 0;
+        std::uint64_t file_hash = 0;
+        std::vector<zone_block> blocks;
+
+        // Block being built and the position of the record following the last one added
+        zone_block current;
+        parser_checkpoint next_position;
+        std::uint64_t recorded = 0;
+
+        static constexpr char magic[4] = { 'T', 'C', 'Z', 'M' };
+        static constexpr std::uint32_t version = 2;
+        static constexpr std::size_t fingerprint_size = 4096;
+
+    public:
+        static constexpr std::uint64_t default_records_per_block = 16384;
+
+        /**
+         * @brief Constructs an empty zone map
+         *
+         * @param records_per_block number of records summarized by a block
+         * @param start position of the first record that is going to be added
+         */
+        zone_map(std::uint64_t records_per_block = default_records_per_block, parser_checkpoint start = {}) :
+            records_per_block(std::max<std::uint64_t>(records_per_block, 1)), next_position(start) {}
+
+        /**
+         * @brief Returns the default sidecar path of a csv file ( path.zonemap )
+         *
+         * @param csv_path path of the csv file
+         * @return std::filesystem::path path of the sidecar file
+         */
+        static std::filesystem::path sidecar_path(const std::filesystem::path& csv_path) {
+            auto path = csv_path;
+            path += ".zonemap";
+            return path;
+        }
+
+        /**
+         * @brief Adds the statistics of the next record
+         *
+         * @param record record following the previously added one
+         * @param end position right after the record ( parser checkpoint )
+         */
+        template<typename Dialect>
+        void add(basic_record<Dialect>& record, const parser_checkpoint& end) {
+            if (current.record_count == 0) {
+                current.begin = next_position;
+                current.first_record = recorded;
+            }
+            const auto& fields = record.get_fields();
+            if (current.columns.size() < fields.size()) {
+                // Columns missing from the earlier records of the block were null in them
+                auto known_columns = current.columns.size();
+                current.columns.resize(fields.size());
+                for (auto column = known_columns; column < fields.size(); column++) {
+                    current.columns[column].null_count = current.record_count;
+                }
+            }
+            for (std::size_t column = 0; column < current.columns.size(); column++) {
+                if (column < fields.size()) {
+                    current.columns[column].add(trim_field(fields[column], Dialect::get_escapecharacter()));
+                }
+                else {
+                    current.columns[column].null_count++;
+                }
+            }
+            current.record_count++;
+            current.end_offset = end.offset;
+            next_position = end;
+            recorded++;
+            if (current.record_count == records_per_block) { finish(); }
+        }
+
+        /**
+         * @brief Closes the block being built ( records added later start a new block )
+         *
+         */
+        void finish() {
+            if (current.record_count == 0) { return; }
+            blocks.push_back(std::move(current));
+            current = zone_block{};
+        }
+
+        /**
+         * @brief Returns the completed blocks
+         *
+         * @return const std::vector<zone_block>& blocks in file order
+         */
+        const std::vector<zone_block>& get_blocks() const {
+            return blocks;
+        }
+
+        std::uint64_t get_records_per_block() const {
+            return records_per_block;
+        }
+
+        /**
+         * @brief Returns the size of the csv file the zone map was saved for ( 0 if it was never saved )
+         *
+         * @return std::uint64_t size in bytes
+         */
+        std::uint64_t get_file_size() const {
+            return file_size;
+        }
+
+        /**
+         * @brief Saves the completed blocks in a sidecar file
+         *
+         * @param csv_path path of the csv file the zone map describes ( its size, modification time and a hash of
+         * its first and last bytes are stored to detect stale sidecars )
+         * @param path path of the sidecar file
+         * @throw std::fstream::failure If the sidecar could not be written
+         */
+        void save(const std::filesystem::path& csv_path, const std::filesystem::path& path) {
+            file_size = std::filesystem::file_size(csv_path);
+            file_time = modification_time(csv_path);
+            file_hash = fingerprint(csv_path, file_size);
+
+            std::ofstream file;
+            file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+            file.open(path, std::ios::binary | std::ios::trunc);
+            file.write(magic, sizeof(magic));
+            write(file, version);
+            write(file, records_per_block);
+            write(file, file_size);
+            write(file, file_time);
+            write(file, file_hash);
+            write(file, static_cast<std::uint64_t>(blocks.size()));
+            for (const auto& block : blocks) {
+                write(file, block.begin.offset);
+                write(file, static_cast<std::uint8_t>(block.begin.in_quotes));
+                write(file, block.end_offset);
+                write(file, block.first_record);
+                write(file, block.record_count);
+                write(file, static_cast<std::uint64_t>(block.columns.size()));
+                for (const auto& column : block.columns) {
+                    write(file, column.null_count);
+                    write(file, column.value_count);
+                    write(file, column.min);
+                    write(file, column.max);
+                    write(file, static_cast<std::uint8_t>(column.numeric));
+                    write(file, column.numeric_min);
+                    write(file, column.numeric_max);
+                }
+            }
+        }
+
+        void save(const std::filesystem::path& csv_path) {
+            save(csv_path, sidecar_path(csv_path));
+        }
+
+        /**
+         * @brief Loads a zone map saved by save
+         *
+         * @param csv_path path of the csv file the zone map describes
+         * @param path path of the sidecar file
+         * @return zone_map loaded zone map
+         * @throw std::runtime_error If the sidecar is not a zone map ( or an older version ) or the csv file changed
+         * since it was saved ( size, modification time or first/last bytes )
+         * @throw std::fstream::failure If the sidecar could not be read
+         */
+        static zone_map load(const std::filesystem::path& csv_path, const std::filesystem::path& path) {
+            std::ifstream file;
+            file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+            file.open(path, std::ios::binary);
+
+            char file_magic[sizeof(magic)];
+            file.read(file_magic, sizeof(file_magic));
+            if (!std::equal(std::begin(magic), std::end(magic), file_magic) || read<std::uint32_t>(file) != version) {
+                throw std::runtime_error("turbo_csv::zone_map: " + path.string() + " is not a zone map");
+            }
+
+            zone_map zones(read<std::uint64_t>(file));
+            zones.file_size = read<std::uint64_t>(file);
+            zones.file_time = read<std::int64_t>(file);
+            zones.file_hash = read<std::uint64_t>(file);
+            auto csv_size = std::filesystem::file_size(csv_path);
+            if (zones.file_size != csv_size || zones.file_time != modification_time(csv_path) ||
+                zones.file_hash != fingerprint(csv_path, csv_size)) {
+                throw std::runtime_error("turbo_csv::zone_map: " + csv_path.string() + " changed since the zone map was saved");
+            }
+
+            zones.blocks.resize(read<std::uint64_t>(file));
+            for (auto& block : zones.blocks) {
+                block.begin.offset = read<std::uint64_t>(file);
+                block.begin.in_quotes = read<std::uint8_t>(file) != 0;
+                block.end_offset = read<std::uint64_t>(file);
+                block.first_record = read<std::uint64_t>(file);
+                block.record_count = read<std::uint64_t>(file);
+                block.columns.resize(read<std::uint64_t>(file));
+                for (auto& column : block.columns) {
+                    column.null_count = read<std::uint64_t>(file);
+                    column.value_count = read<std::uint64_t>(file);
+                    column.min = read<std::string>(file);
+                    column.max = read<std::string>(file);
+                    column.numeric = read<std::uint8_t>(file) != 0;
+                    column.numeric_min = read<double>(file);
+                    column.numeric_max = read<double>(file);
+                }
+            }
+            if (!zones.blocks.empty()) {
+                zones.recorded = zones.blocks.back().first_record + zones.blocks.back().record_count;
+                zones.next_position = parser_checkpoint{ zones.blocks.back().end_offset, false };
+            }
+            return zones;
+        }
+
+        static zone_map load(const std::filesystem::path& csv_path) {
+            return load(csv_path, sidecar_path(csv_path));
+        }
+
+    private:
+
+        static std::int64_t modification_time(const std::filesystem::path& csv_path) {
+            return static_cast<std::int64_t>(std::filesystem::last_write_time(csv_path).time_since_epoch().count());
+        }
+
+        // FNV-1a hash of the first and last fingerprint_size bytes of the file ( rewrites keeping the size and
+        // modification time are caught as long as they touch either end )
+        static std::uint64_t fingerprint(const std::filesystem::path& csv_path, std::uint64_t size) {
+            std::ifstream file;
+            file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+            file.open(csv_path, std::ios::binary);
+            std::uint64_t hash = 0xcbf29ce484222325ull;
+            std::string bytes;
+            auto hash_range = [&](std::uint64_t offset, std::uint64_t count) {
+                bytes.resize(count);
+                file.seekg(static_cast<std::streamoff>(offset));
+                file.read(bytes.data(), static_cast<std::streamsize>(count));
+                for (auto byte : bytes) {
+                    hash ^= static_cast<unsigned char>(byte);
+                    hash *= 0x100000001b3ull;
+                }
+            };
+            auto edge = std::min<std::uint64_t>(size, fingerprint_size);
+            hash_range(0, edge);
+            hash_range(size - edge, edge);
+            return hash;
+        }
+
+        // Sidecars are written in the byte order of the machine, they are caches rather than an exchange format
+        template<typename T>
+        static void write(std::ofstream& file, const T& value) {
+            if constexpr (std::is_same_v<T, std::string>) {
+                write(file, static_cast<std::uint64_t>(value.size()));
+                file.write(value.data(), static_cast<std::streamsize>(value.size()));
+            }
+            else {
+                file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+        }
+
+        template<typename T>
+        static T read(std::ifstream& file) {
+            T value{};
+            if constexpr (std::is_same_v<T, std::string>) {
+                value.resize(read<std::uint64_t>(file));
+                file.read(value.data(), static_cast<std::streamsize>(value.size()));
+            }
+            else {
+                file.read(reinterpret_cast<char*>(&value), sizeof(T));
+            }
+            return value;
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,69 @@
+#define BOOST_TEST_MODULE aggregate_test
+
+#include<aggregate.hpp>
+#include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
+#include<filesystem>
+#include<fstream>
+
+
+// Writes rows "region,status,amount" where amount is the row number ( every 10th amount is empty )
+auto write_sales(const std::string& name,int rows){
+    turbo_csv::testing::temp_file path("aggregate",name);
+    std::ofstream file(path.get_path());
+    file<<"region,status,amount\n";
+    std::vector<std::string> regions{"north","south","east"};
+    for(int row=0;row<rows;row++){
+        file<<regions[row%3]<<","<<(row%2?"open":"closed")<<",";
+        if(row%10!=0){file<<row;}
+        file<<"\n";
+    }
+    return path;
+}
+
+BOOST_AUTO_TEST_SUITE(group_by)
+
+BOOST_AUTO_TEST_CASE(single_key_column){
+    auto path=write_sales("single.csv",3000);
+    turbo_csv::reader csv_reader(path,true);
+
+    auto groups=turbo_csv::group_by(csv_reader,{0},{2},4,64);
+
+    BOOST_REQUIRE_EQUAL(3,groups.size());
+    BOOST_REQUIRE_EQUAL("east",groups[0].keys.front());
+    BOOST_REQUIRE_EQUAL("north",groups[1].keys.front());
+
+    // north has rows 0,3,6...2997 of which the multiples of 10 are empty
+    double expected_sum=0;
+    std::size_t expected_values=0;
+    for(int row=0;row<3000;row+=3){
+        if(row%10!=0){expected_sum+=row;expected_values++;}
+    }
+    auto& north=groups[1];
+    BOOST_REQUIRE_EQUAL(1000,north.count);
+    BOOST_REQUIRE_EQUAL(expected_values,north.values.front().count);
+    BOOST_REQUIRE_EQUAL(expected_sum,north.values.front().sum);
+    BOOST_REQUIRE_EQUAL(3,north.values.front().min);
+    BOOST_REQUIRE_EQUAL(2997,north.values.front().max);
+    BOOST_REQUIRE_CLOSE(expected_sum/expected_values,north.values.front().mean(),1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(multiple_key_columns){
+    auto path=write_sales("multiple.csv",600);
+    turbo_csv::experimental_reader csv_reader(path,true);
+
+    auto groups=turbo_csv::group_by(csv_reader,{0,1},{2},3,16);
+
+    BOOST_REQUIRE_EQUAL(6,groups.size());
+    std::size_t total=0;
+    for(auto& group:groups){
+        BOOST_REQUIRE_EQUAL(2,group.keys.size());
+        BOOST_REQUIRE_EQUAL(100,group.count);
+        total+=group.count;
+    }
+    BOOST_REQUIRE_EQUAL(600,total);
+    BOOST_REQUIRE_EQUAL("closed",groups[0].keys[1]);
+    BOOST_REQUIRE_EQUAL("east",groups[0].keys[0]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,51 @@
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+// Replaces the global operator new/delete to count the allocations made by the library. Must be included by
+// exactly one translation unit of an executable ( the replacement operators are not inline )
+
+#include<new>
+#include<atomic>
+#include<cstdlib>
+#include<cstdint>
+
+namespace turbo_csv::testing {
+
+    struct allocation_counts {
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    inline std::atomic<std::uint64_t> allocation_count = 0;
+    inline std::atomic<std::uint64_t> allocated_bytes = 0;
+
+    /**
+     * @brief Counts the allocations made (by every thread) while the scope is alive
+     *
+     */
+    class allocation_scope {
+        allocation_counts start;
+    public:
+        allocation_scope() :start{ allocation_count.load(), allocated_bytes.load() } {}
+
+        allocation_counts get() const {
+            return { allocation_count.load() - start.allocations, allocated_bytes.load() - start.bytes };
+        }
+    };
+
+    inline void* counted_allocate(std::size_t size) {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+        if (void* memory = std::malloc(size != 0 ? size : 1)) { return memory; }
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(std::size_t size) { return turbo_csv::testing::counted_allocate(size); }
+void* operator new[](std::size_t size) { return turbo_csv::testing::counted_allocate(size); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+
+#endif
@@ -0,0 +1,117 @@
+#define BOOST_TEST_MODULE allocations_test
+
+#include"allocation_counter.hpp"
+#include<turbo_csv.hpp>
+#include<boost/test/unit_test.hpp>
+
+
+auto get_examples_dir() {
+    return std::string(EXAMPLES);
+}
+
+// Allocations per record allowed for the readers retaining their records. Every record grows its own raw data,
+// quote positions and field views from empty ( about 8 allocations per record of annual_enterprise.csv )
+constexpr double retained_record_budget = 8;
+
+template<typename Reader>
+auto count_retained(const std::string& path, std::size_t& record_count) {
+    Reader csv_reader(path);
+    turbo_csv::testing::allocation_scope scope;
+    record_count = csv_reader.get_totalrecords();
+    for (std::size_t i = 0; i < record_count; i++) { csv_reader[i].get_fields(); }
+    return scope.get();
+}
+
+template<typename Reader>
+auto count_streamed(const std::string& path, std::size_t& record_count) {
+    turbo_csv::basic_record<turbo_csv::dialect> record;
+    {
+        // Warm up pass: buffers of the record grow to the size of the largest row
+        Reader csv_reader(path);
+        while (csv_reader.next(record)) { record.get_fields(); }
+    }
+    Reader csv_reader(path);
+    record_count = 0;
+    turbo_csv::testing::allocation_scope scope;
+    while (csv_reader.next(record)) {
+        record.get_fields();
+        record_count++;
+    }
+    return scope.get();
+}
+
+// Index of the last record larger than all the ones before it ( raw size, fields or quotes ). Buffers reused from
+// record to record stop growing once it is read
+std::size_t last_growing_record(const std::string& path) {
+    turbo_csv::reader csv_reader(path);
+    turbo_csv::basic_record<turbo_csv::dialect> record;
+    std::size_t largest_raw_size = 0, most_fields = 0, most_quotes = 0, last_growing = 0;
+    for (std::size_t index = 0; csv_reader.next(record); index++) {
+        std::size_t quotes = 0;
+        for (auto field : record.get_fields()) { quotes += static_cast<std::size_t>(std::count(field.begin(), field.end(), '"')); }
+        if (record.get_raw_size() > largest_raw_size || record.get_field_count() > most_fields || quotes > most_quotes) {
+            last_growing = index;
+        }
+        largest_raw_size = std::max<std::size_t>(largest_raw_size, record.get_raw_size());
+        most_fields = std::max<std::size_t>(most_fields, record.get_field_count());
+        most_quotes = std::max(most_quotes, quotes);
+    }
+    return last_growing;
+}
+
+void report(const std::string& name, turbo_csv::testing::allocation_counts counts, std::size_t record_count) {
+    BOOST_TEST_MESSAGE(name << " : " << static_cast<double>(counts.allocations) / record_count << " allocations/record "
+        << static_cast<double>(counts.bytes) / record_count << " bytes/record");
+}
+
+BOOST_AUTO_TEST_SUITE(allocations)
+
+BOOST_AUTO_TEST_CASE(counter_counts_allocations){
+    turbo_csv::testing::allocation_scope scope;
+    auto value = std::make_unique<std::uint64_t>(42);
+    BOOST_CHECK_EQUAL(scope.get().allocations, 1);
+    BOOST_CHECK_EQUAL(scope.get().bytes, sizeof(std::uint64_t));
+}
+
+BOOST_AUTO_TEST_CASE(reader_within_budget){
+    std::size_t record_count;
+    auto counts = count_retained<turbo_csv::reader>(get_examples_dir() + "annual_enterprise.csv", record_count);
+    report("reader", counts, record_count);
+    BOOST_CHECK_LE(static_cast<double>(counts.allocations) / record_count, retained_record_budget);
+}
+
+BOOST_AUTO_TEST_CASE(experimental_reader_within_budget){
+    std::size_t record_count;
+    auto counts = count_retained<turbo_csv::experimental_reader>(get_examples_dir() + "annual_enterprise.csv", record_count);
+    report("experimental_reader", counts, record_count);
+    BOOST_CHECK_LE(static_cast<double>(counts.allocations) / record_count, retained_record_budget);
+}
+
+BOOST_AUTO_TEST_CASE(streaming_does_not_allocate){
+    std::size_t record_count;
+    auto counts = count_streamed<turbo_csv::reader>(get_examples_dir() + "annual_enterprise.csv", record_count);
+    report("reader streaming", counts, record_count);
+    BOOST_CHECK_EQUAL(record_count, 13933);
+    BOOST_CHECK_EQUAL(counts.allocations, 0);
+
+    counts = count_streamed<turbo_csv::experimental_reader>(get_examples_dir() + "annual_enterprise.csv", record_count);
+    report("experimental_reader streaming", counts, record_count);
+    BOOST_CHECK_EQUAL(counts.allocations, 0);
+}
+
+BOOST_AUTO_TEST_CASE(stream_range_does_not_allocate){
+    auto path = get_examples_dir() + "annual_enterprise.csv";
+    auto warm_up_records = last_growing_record(path) + 1;
+    turbo_csv::reader csv_reader(path);
+    auto records = csv_reader.stream();
+    auto current = records.begin();
+    // Reach the largest row once so that the pooled record stops growing
+    for (std::size_t warm_up = 0; current != records.end() && warm_up < warm_up_records; ++current, ++warm_up) { (*current).get_fields(); }
+    BOOST_REQUIRE(current != records.end());
+
+    turbo_csv::testing::allocation_scope scope;
+    for (; current != records.end(); ++current) { (*current).get_fields(); }
+    BOOST_CHECK_EQUAL(scope.get().allocations, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
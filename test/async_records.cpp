@@ -0,0 +1,135 @@
+#define BOOST_TEST_MODULE async_records_test
+
+#include<async_records.hpp>
+#include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
+#include<condition_variable>
+#include<filesystem>
+#include<coroutine>
+#include<fstream>
+#include<deque>
+
+
+// Single threaded event loop : suspended coroutines are posted back and resumed on the thread running the loop
+class event_loop {
+    std::mutex handles_resx;
+    std::condition_variable handles_changed;
+    std::deque<std::coroutine_handle<>> handles;
+    bool stopped=false;
+
+public:
+    void post(std::coroutine_handle<> handle){
+        {
+            std::lock_guard<std::mutex> lck(handles_resx);
+            handles.push_back(handle);
+        }
+        handles_changed.notify_one();
+    }
+
+    void stop(){
+        {
+            std::lock_guard<std::mutex> lck(handles_resx);
+            stopped=true;
+        }
+        handles_changed.notify_one();
+    }
+
+    // Returns the number of coroutine resumptions
+    std::size_t run(){
+        std::size_t resumed=0;
+        while(true){
+            std::unique_lock<std::mutex> lck(handles_resx);
+            handles_changed.wait(lck,[this](){return stopped||!handles.empty();});
+            if(handles.empty()){return resumed;}
+            auto handle=handles.front();
+            handles.pop_front();
+            lck.unlock();
+            handle.resume();
+            resumed++;
+        }
+    }
+};
+
+struct task {
+    struct promise_type {
+        task get_return_object(){return {};}
+        std::suspend_never initial_suspend() noexcept {return {};}
+        std::suspend_never final_suspend() noexcept {return {};}
+        void return_void(){}
+        void unhandled_exception(){std::terminate();}
+    };
+};
+
+BOOST_AUTO_TEST_SUITE(async_records)
+
+BOOST_AUTO_TEST_CASE(records_awaited_on_event_loop_thread){
+    auto path=turbo_csv::testing::write_amounts("async_records","records.csv",20000);
+    turbo_csv::experimental_reader csv_reader(path,true);
+    event_loop loop;
+    auto loop_thread=std::this_thread::get_id();
+
+    std::size_t record_count=0,amount_sum=0;
+    bool same_thread=true;
+    auto consume=[&]()->task{
+        auto stream=turbo_csv::async_records(csv_reader,[&loop](std::coroutine_handle<> handle){loop.post(handle);},{256,2});
+        while(auto record=co_await stream->next()){
+            same_thread=same_thread&&std::this_thread::get_id()==loop_thread;
+            record_count++;
+            amount_sum+=record->get_field<std::size_t>(1);
+        }
+        loop.stop();
+    };
+
+    consume();
+    loop.run();
+
+    BOOST_REQUIRE(same_thread);
+    BOOST_REQUIRE_EQUAL(20000,record_count);
+    BOOST_REQUIRE_EQUAL(200*4950,amount_sum);
+    // Records are not retained by the reader
+    BOOST_REQUIRE_EQUAL(1,csv_reader.get_active_recordcount());
+}
+
+BOOST_AUTO_TEST_CASE(batches_awaited){
+    auto path=turbo_csv::testing::write_amounts("async_records","batches.csv",1000);
+    turbo_csv::reader csv_reader(path,true);
+    event_loop loop;
+
+    std::vector<std::size_t> batch_sizes;
+    std::size_t first_id=1;
+    auto consume=[&]()->task{
+        auto stream=turbo_csv::async_records(csv_reader,[&loop](std::coroutine_handle<> handle){loop.post(handle);},{300,1});
+        while(auto batch=co_await stream->next_batch()){
+            if(batch_sizes.empty()){first_id=batch->front().get_field<std::size_t>(0);}
+            batch_sizes.push_back(batch->size());
+        }
+        loop.stop();
+    };
+
+    consume();
+    loop.run();
+
+    BOOST_REQUIRE_EQUAL(0,first_id);
+    BOOST_REQUIRE(batch_sizes==std::vector<std::size_t>({300,300,300,100}));
+}
+
+BOOST_AUTO_TEST_CASE(stream_dropped_before_end){
+    auto path=turbo_csv::testing::write_amounts("async_records","dropped.csv",50000);
+    turbo_csv::reader csv_reader(path,true);
+    event_loop loop;
+
+    std::size_t record_count=0;
+    auto consume=[&]()->task{
+        auto stream=turbo_csv::async_records(csv_reader,[&loop](std::coroutine_handle<> handle){loop.post(handle);},{64,2});
+        while(co_await stream->next()){
+            if(++record_count==100){break;}
+        }
+        loop.stop();
+    };
+
+    consume();
+    loop.run();
+    BOOST_REQUIRE_EQUAL(100,record_count);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
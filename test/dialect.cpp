@@ -41,4 +41,30 @@ BOOST_AUTO_TEST_CASE(escape_character){
 
 
 
+BOOST_AUTO_TEST_CASE(multibyte_seperators){
+    using pipe_dialect=delimited_dialect<"||","\x1e">;
+    using traits=dialect_traits<pipe_dialect>;
+
+    BOOST_REQUIRE(traits::multibyte_fieldseperator);
+    BOOST_REQUIRE(!traits::multibyte_recordseperator);
+    BOOST_REQUIRE(!traits::has_quoteescape);
+    BOOST_REQUIRE_EQUAL("||",pipe_dialect::get_fieldseperator_sequence());
+    BOOST_REQUIRE_EQUAL('\x1e',pipe_dialect::get_recordseperator());
+
+    std::string_view data="a||b|c";
+    BOOST_ASSERT(traits::fieldseperator_at(data,1));
+    BOOST_ASSERT(!traits::fieldseperator_at(data,4));
+    BOOST_ASSERT(!traits::fieldseperator_at(data,5));
+    BOOST_ASSERT(traits::fieldseperator_before(data,3));
+}
+
+BOOST_AUTO_TEST_CASE(default_dialect_is_single_byte){
+    using backslash_dialect=delimited_dialect<",","\n",'"','\\'>;
+
+    BOOST_REQUIRE(dialect_traits<dialect>::single_byte);
+    BOOST_REQUIRE(dialect_traits<delimited_dialect<",">>::single_byte);
+    BOOST_REQUIRE(!dialect_traits<backslash_dialect>::single_byte);
+    BOOST_REQUIRE_EQUAL('\\',backslash_dialect::get_quoteescape());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,85 @@
+#define BOOST_TEST_MODULE dictionary_column_test
+
+#include<dictionary_column.hpp>
+#include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
+#include<filesystem>
+#include<fstream>
+
+
+// Writes rows "id,country,note" where country cycles through 7 values and every 100th row has no country
+auto write_visits(const std::string& name,int rows){
+    turbo_csv::testing::temp_file path("dictionary_column",name);
+    std::ofstream file(path.get_path());
+    file<<"id,country,note\n";
+    for(int row=0;row<rows;row++){
+        file<<row;
+        if(row%100!=99){file<<", \"country"<<row%7<<"\",note"<<row;}
+        file<<"\n";
+    }
+    return path;
+}
+
+BOOST_AUTO_TEST_SUITE(dictionary_column)
+
+BOOST_AUTO_TEST_CASE(low_cardinality_column_encoded_in_parallel){
+    auto path=write_visits("parallel.csv",20000);
+    turbo_csv::reader csv_reader(path,true);
+
+    auto countries=turbo_csv::get_dictionary_column(csv_reader,1,4,128);
+
+    // Records are not retained by the reader
+    BOOST_REQUIRE_EQUAL(1,csv_reader.get_active_recordcount());
+    BOOST_REQUIRE_EQUAL(20000,countries.size());
+    BOOST_REQUIRE_EQUAL(7,countries.get_values().size());
+    BOOST_REQUIRE(std::is_sorted(countries.get_values().begin(),countries.get_values().end()));
+
+    for(int row=0;row<20000;row++){
+        if(row%100==99){
+            BOOST_REQUIRE(countries.is_null(row));
+            BOOST_REQUIRE_EQUAL(turbo_csv::dictionary_column::null_code,countries.get_codes()[row]);
+        }
+        else{
+            BOOST_REQUIRE_EQUAL("country"+std::to_string(row%7),countries[row]);
+        }
+    }
+
+    auto code=countries.find_code("country3");
+    BOOST_REQUIRE(code.has_value());
+    BOOST_REQUIRE_EQUAL(3,code.value());
+    BOOST_REQUIRE(!countries.find_code("country7").has_value());
+
+    auto counts=countries.value_counts();
+    std::size_t total=0;
+    for(auto count: counts){total+=count;}
+    BOOST_REQUIRE_EQUAL(19800,total);
+    BOOST_REQUIRE_LT(countries.memory_size(),20000*sizeof(std::int32_t)+1024);
+}
+
+BOOST_AUTO_TEST_CASE(single_thread_matches_parallel_encoding){
+    auto path=write_visits("single.csv",3000);
+    turbo_csv::reader serial_reader(path,true);
+    turbo_csv::reader parallel_reader(path,true);
+
+    auto serial=turbo_csv::get_dictionary_column(serial_reader,2,1,4096);
+    auto parallel=turbo_csv::get_dictionary_column(parallel_reader,2,3,7);
+
+    BOOST_REQUIRE_EQUAL(serial.get_values().size(),parallel.get_values().size());
+    BOOST_REQUIRE(serial.get_codes()==parallel.get_codes());
+    BOOST_REQUIRE_EQUAL("note0",parallel[0]);
+    BOOST_REQUIRE_EQUAL("note2998",parallel[2998]);
+}
+
+BOOST_AUTO_TEST_CASE(empty_fields_are_null){
+    turbo_csv::testing::temp_file path("dictionary_column","empty.csv");
+    std::ofstream(path.get_path())<<"1,a\n2, \n3,\"\"\n4\n5,a\n";
+    turbo_csv::reader csv_reader(path);
+
+    // Same fields as the ones profile_columns counts as null
+    auto column=turbo_csv::get_dictionary_column(csv_reader,1,2,1);
+    BOOST_REQUIRE_EQUAL(5,column.size());
+    BOOST_REQUIRE_EQUAL(1,column.get_values().size());
+    BOOST_REQUIRE(!column.is_null(0)&&column.is_null(1)&&column.is_null(2)&&column.is_null(3)&&!column.is_null(4));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+#define BOOST_TEST_MODULE external_sort_test
+
+#include<external_sort.hpp>
+#include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
+#include<filesystem>
+#include<fstream>
+#include<random>
+
+
+auto temp_path(const std::string& name){
+    return turbo_csv::testing::temp_file("sort_test",name);
+}
+
+auto read_lines(const std::string& path){
+    std::ifstream file(path);
+    std::vector<std::string> lines;
+    std::string line;
+    while(std::getline(file,line)){lines.push_back(line);}
+    return lines;
+}
+
+// Writes rows "id,key,payload" with random keys and returns the rows
+auto write_rows(const std::string& path,int rows,bool numeric){
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(-5000,5000);
+    std::vector<std::string> lines;
+    std::ofstream file(path);
+    file<<"id,key,payload\n";
+    for(int row=0;row<rows;row++){
+        auto key=distribution(generator);
+        auto line=std::to_string(row)+","+(numeric?std::to_string(key):"key"+std::to_string(key))+",payload";
+        file<<line<<"\n";
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+auto key_of(const std::string& line){
+    auto first=line.find(',');
+    return line.substr(first+1,line.find(',',first+1)-first-1);
+}
+
+BOOST_AUTO_TEST_SUITE(external_sort)
+
+BOOST_AUTO_TEST_CASE(sort_in_memory){
+    auto input=temp_path("memory_in.csv"),output=temp_path("memory_out.csv");
+    auto lines=write_rows(input,1000,false);
+
+    turbo_csv::sort_options options;
+    options.treat_first_record_as_header=true;
+    turbo_csv::sorter(1,options).sort(input,output);
+
+    std::stable_sort(lines.begin(),lines.end(),[](auto& lhs,auto& rhs){return key_of(lhs)<key_of(rhs);});
+    auto sorted=read_lines(output);
+
+    BOOST_REQUIRE_EQUAL("id,key,payload",sorted.front());
+    BOOST_REQUIRE_EQUAL_COLLECTIONS(lines.begin(),lines.end(),sorted.begin()+1,sorted.end());
+}
+
+BOOST_AUTO_TEST_CASE(sort_spilled_runs_multiple_passes){
+    auto input=temp_path("spill_in.csv"),output=temp_path("spill_out.csv");
+    auto lines=write_rows(input,20000,true);
+
+    turbo_csv::sort_options options;
+    options.treat_first_record_as_header=true;
+    options.numeric=true;
+    options.memory_budget=64*1024;
+    options.max_merge_width=4;
+    options.thread_count=3;
+    turbo_csv::sorter(1,options).sort(input,output);
+
+    std::stable_sort(lines.begin(),lines.end(),[](auto& lhs,auto& rhs){return std::stoi(key_of(lhs))<std::stoi(key_of(rhs));});
+    auto sorted=read_lines(output);
+
+    BOOST_REQUIRE_EQUAL(lines.size()+1,sorted.size());
+    for(std::size_t i=0;i<lines.size();i++){
+        BOOST_REQUIRE_EQUAL(key_of(lines[i]),key_of(sorted[i+1]));
+    }
+
+    // All the runs are removed once merged
+    for(auto& entry:std::filesystem::directory_iterator(options.temp_directory)){
+        BOOST_REQUIRE(entry.path().filename().string().rfind("turbo_csv_sort_",0)!=0 ||
+            entry.path().filename().string().rfind("turbo_csv_sort_test_",0)==0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sort_merge_width_limited_by_reader_buffers){
+    auto input=temp_path("buffered_in.csv"),output=temp_path("buffered_out.csv");
+    auto lines=write_rows(input,60000,false);
+
+    // Every run reader holds two 1MB buffers, so the budget only allows merging two runs at once
+    turbo_csv::sort_options options;
+    options.treat_first_record_as_header=true;
+    options.memory_budget=4*1000000;
+    turbo_csv::basic_sorter<turbo_csv::parser,turbo_csv::file_reader<1000000>,turbo_csv::dialect>(1,options).sort(input,output);
+
+    std::stable_sort(lines.begin(),lines.end(),[](auto& lhs,auto& rhs){return key_of(lhs)<key_of(rhs);});
+    auto sorted=read_lines(output);
+
+    BOOST_REQUIRE_EQUAL("id,key,payload",sorted.front());
+    BOOST_REQUIRE_EQUAL_COLLECTIONS(lines.begin(),lines.end(),sorted.begin()+1,sorted.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,7 @@
 #include <csv_file_reader.hpp>
 #include <boost/test/unit_test.hpp>
 #include <sstream>
+#include "temp_file.hpp"
 
 
 
@@ -25,6 +26,39 @@ BOOST_AUTO_TEST_CASE(throw_if_file_not_exists){
 
 }
 
+BOOST_AUTO_TEST_CASE(seek_to_offset){
+    file_reader<5> my_reader(examples_dir()+"cars.csv");
+    std::string cars_data="2020,Maruti Suzuki,Brezza,1.6";
+    std::string data;
+
+    my_reader.get_byte();
+    my_reader.seek(29);
+
+    while(true){
+        auto byte= my_reader.get_byte();
+        if(byte.has_value()){data.push_back(byte.value());}
+        else{break;}
+    }
+
+    BOOST_REQUIRE_EQUAL(cars_data,data);
+    BOOST_REQUIRE_EQUAL(58,my_reader.get_current_readcount());
+}
+
+BOOST_AUTO_TEST_CASE(get_method_buffer_marker_characters){
+    turbo_csv::testing::temp_file path("file_reader","markers.csv");
+    std::string marker_data="price,$10\n#comment,$$\n";
+    std::ofstream(path.get_path())<<marker_data;
+
+    file_reader<4> my_reader(path);
+    std::string data;
+    while(true){
+        auto byte= my_reader.get_byte();
+        if(byte.has_value()){data.push_back(byte.value());}
+        else{break;}
+    }
+
+    BOOST_REQUIRE_EQUAL(marker_data,data);
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(file_reader_methods)
@@ -117,4 +151,103 @@ BOOST_AUTO_TEST_CASE(get_method_read_only_few_bytes){
 
     BOOST_REQUIRE_EQUAL(cars_data,data);
 }
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_CASE(seek_to_offset){
+    file_reader<5> my_reader(examples_dir()+"cars.csv");
+    std::string cars_data="2020,Maruti Suzuki,Brezza,1.6";
+    std::string data;
+
+    my_reader.get_byte();
+    my_reader.seek(29);
+
+    while(true){
+        auto byte= my_reader.get_byte();
+        if(byte.has_value()){data.push_back(byte.value());}
+        else{break;}
+    }
+
+    BOOST_REQUIRE_EQUAL(cars_data,data);
+    BOOST_REQUIRE_EQUAL(58,my_reader.get_current_readcount());
+}
+
+BOOST_AUTO_TEST_CASE(get_method_buffer_marker_characters){
+    turbo_csv::testing::temp_file path("file_reader","buffer_markers.csv");
+    std::string marker_data="price,$10\n#comment,$$\n";
+    std::ofstream(path.get_path())<<marker_data;
+
+    file_reader<4> my_reader(path);
+    std::string data;
+    while(true){
+        auto byte= my_reader.get_byte();
+        if(byte.has_value()){data.push_back(byte.value());}
+        else{break;}
+    }
+
+    BOOST_REQUIRE_EQUAL(marker_data,data);
+}
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE(utf8_validation)
+
+std::string read_all(const std::string& path, utf8_options options, std::optional<std::uint64_t>& first_invalid, std::uint64_t& invalid_count){
+    file_reader<5> my_reader(path);
+    my_reader.set_utf8_options(options);
+    std::string data;
+    while(auto byte=my_reader.get_byte()){data.push_back(byte.value());}
+    first_invalid=my_reader.get_first_invalid_utf8_offset();
+    invalid_count=my_reader.get_invalid_utf8_count();
+    return data;
+}
+
+BOOST_AUTO_TEST_CASE(valid_multibyte_sequences_across_buffers){
+    turbo_csv::testing::temp_file path("file_reader","utf8_valid.csv");
+    // Sequences of every length split at different buffer boundaries
+    std::string valid_data="a,\xC3\xA9t\xC3\xA9,\xE2\x82\xAC\n\xF0\x9F\x98\x80,na\xC3\xAFve\n";
+    std::ofstream(path.get_path(),std::ios::binary)<<valid_data;
+
+    std::optional<std::uint64_t> first_invalid;
+    std::uint64_t invalid_count;
+    BOOST_REQUIRE_EQUAL(read_all(path,{},first_invalid,invalid_count),valid_data);
+    BOOST_REQUIRE(!first_invalid.has_value());
+    BOOST_REQUIRE_EQUAL(invalid_count,0);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_sequences_reported){
+    turbo_csv::testing::temp_file path("file_reader","utf8_report.csv");
+    std::string invalid_data="abc,\xC3(,\xED\xA0\x80,ok\n\xE2\x82";
+    std::ofstream(path.get_path(),std::ios::binary)<<invalid_data;
+
+    std::vector<std::uint64_t> reported;
+    utf8_options options;
+    options.on_invalid=[&reported](std::uint64_t offset){reported.push_back(offset);};
+
+    std::optional<std::uint64_t> first_invalid;
+    std::uint64_t invalid_count;
+    BOOST_REQUIRE_EQUAL(read_all(path,options,first_invalid,invalid_count),invalid_data);
+    BOOST_REQUIRE(first_invalid.has_value());
+    BOOST_REQUIRE_EQUAL(first_invalid.value(),4);
+    // Lone lead byte, 3 bytes of an encoded surrogate and a sequence truncated at the end of file
+    std::vector<std::uint64_t> expected{4,7,8,9,14};
+    BOOST_REQUIRE_EQUAL_COLLECTIONS(reported.begin(),reported.end(),expected.begin(),expected.end());
+    BOOST_REQUIRE_EQUAL(invalid_count,5);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_bytes_replaced){
+    turbo_csv::testing::temp_file path("file_reader","utf8_replace.csv");
+    std::ofstream(path.get_path(),std::ios::binary)<<"abc,\xC3(,\xE2\x82\xAC\xFF\n\xE2\x82";
+
+    utf8_options options;
+    options.action=utf8_action::replace;
+    std::optional<std::uint64_t> first_invalid;
+    std::uint64_t invalid_count;
+    BOOST_REQUIRE_EQUAL(read_all(path,options,first_invalid,invalid_count),"abc,?(,\xE2\x82\xAC?\n??");
+    BOOST_REQUIRE_EQUAL(invalid_count,3);
+}
+
+BOOST_AUTO_TEST_CASE(ascii_blocks_skipped){
+    std::string block(40,'x');
+    block[37]='\x80';
+    utf8_validator validator;
+    BOOST_REQUIRE_EQUAL(validator.process(block.data(),block.size(),100,true),block.size());
+    BOOST_REQUIRE_EQUAL(validator.first_invalid_offset().value(),137);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
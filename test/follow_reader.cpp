@@ -0,0 +1,93 @@
+#define BOOST_TEST_MODULE follow_reader_test
+
+#include<follow_reader.hpp>
+#include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
+#include<filesystem>
+#include<fstream>
+
+
+auto log_path(const std::string& name){
+    turbo_csv::testing::temp_file path("follow",name);
+    std::ofstream(path.get_path()).close();
+    return path;
+}
+
+void append(const std::string& path,const std::string& data){
+    std::ofstream file(path,std::ios::app|std::ios::binary);
+    file<<data;
+}
+
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_SUITE(follow_reader)
+
+BOOST_AUTO_TEST_CASE(partial_record_held_back){
+    auto path=log_path("partial.csv");
+    turbo_csv::follow_reader csv_reader(path);
+    turbo_csv::basic_record<turbo_csv::dialect> rec;
+
+    BOOST_REQUIRE(!csv_reader.next(rec));
+
+    append(path,"1,first\n2,sec");
+    BOOST_REQUIRE(csv_reader.next(rec,100ms));
+    BOOST_REQUIRE_EQUAL("first",rec[1]);
+    BOOST_REQUIRE(!csv_reader.next(rec,20ms));
+
+    append(path,"ond\n");
+    BOOST_REQUIRE(csv_reader.next(rec,100ms));
+    BOOST_REQUIRE_EQUAL("second",rec[1]);
+}
+
+BOOST_AUTO_TEST_CASE(quoted_record_seperator){
+    auto path=log_path("quoted.csv");
+    turbo_csv::follow_reader csv_reader(path);
+    turbo_csv::basic_record<turbo_csv::dialect> rec;
+
+    append(path,"1,\"two\nlines");
+    BOOST_REQUIRE(!csv_reader.next(rec,20ms));
+
+    append(path,"\"\n");
+    BOOST_REQUIRE(csv_reader.next(rec,100ms));
+    BOOST_REQUIRE_EQUAL("\"two\nlines\"",rec[1]);
+}
+
+BOOST_AUTO_TEST_CASE(wait_for_appended_record){
+    auto path=log_path("wait.csv");
+    turbo_csv::follow_reader csv_reader(path);
+    turbo_csv::basic_record<turbo_csv::dialect> rec;
+
+    std::thread writer([&path](){
+        std::this_thread::sleep_for(50ms);
+        append(path,"3,third\n");
+    });
+    BOOST_REQUIRE(csv_reader.next(rec,5000ms));
+    BOOST_REQUIRE_EQUAL("third",rec[1]);
+    writer.join();
+}
+
+BOOST_AUTO_TEST_CASE(rotation_and_truncation){
+    auto path=log_path("rotated.csv");
+    turbo_csv::testing::temp_file rotated_path("follow","rotated.csv.1");
+    turbo_csv::follow_reader csv_reader(path);
+    turbo_csv::basic_record<turbo_csv::dialect> rec;
+
+    append(path,"1,old\n2,unterminated");
+    BOOST_REQUIRE(csv_reader.next(rec,100ms));
+    BOOST_REQUIRE_EQUAL("old",rec[1]);
+
+    std::filesystem::rename(path,rotated_path);
+    append(path,"3,new\n");
+
+    BOOST_REQUIRE(csv_reader.next(rec,1000ms));
+    BOOST_REQUIRE_EQUAL("unterminated",rec[1]);
+    BOOST_REQUIRE(csv_reader.next(rec,1000ms));
+    BOOST_REQUIRE_EQUAL("new",rec[1]);
+
+    std::filesystem::resize_file(path,0);
+    append(path,"4,x\n");
+    BOOST_REQUIRE(csv_reader.next(rec,1000ms));
+    BOOST_REQUIRE_EQUAL("x",rec[1]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
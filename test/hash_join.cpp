@@ -0,0 +1,143 @@
+#define BOOST_TEST_MODULE hash_join_test
+
+#include<hash_join.hpp>
+#include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
+#include<filesystem>
+#include<fstream>
+#include<mutex>
+#include<map>
+
+
+// Customers "id,name" for ids 0..99 ( id 7 has two records ) and orders "order,customer,amount" where
+// customer is order%120 ( customers 100..119 do not exist )
+auto write_tables(const std::string& name){
+    turbo_csv::testing::temp_file customers("hash_join","customers_"+name);
+    turbo_csv::testing::temp_file orders("hash_join","orders_"+name);
+
+    std::ofstream customer_file(customers.get_path());
+    customer_file<<"id,name\n";
+    for(int id=0;id<100;id++){customer_file<<id<<",\"customer "<<id<<"\"\n";}
+    customer_file<<" 7 ,\"customer 7, second\"\n";
+
+    std::ofstream order_file(orders.get_path());
+    order_file<<"order,customer,amount\n";
+    for(int order=0;order<1200;order++){order_file<<order<<","<<order%120<<","<<order*2<<"\n";}
+    return std::make_pair(std::move(orders),std::move(customers));
+}
+
+// Joined pairs keyed by order number ( build name is empty for unmatched orders )
+auto collect(turbo_csv::joiner& csv_joiner,const std::string& orders,const std::string& customers){
+    std::mutex results_resx;
+    std::multimap<int,std::string> results;
+    csv_joiner.join(orders,customers,[&](auto& order,auto* customer){
+        auto name=customer ? std::string(customer->get_fields()[1]) : std::string();
+        std::lock_guard<std::mutex> lck(results_resx);
+        results.emplace(order.template get_field<int>(0),name);
+    });
+    return results;
+}
+
+BOOST_AUTO_TEST_SUITE(hash_join)
+
+BOOST_AUTO_TEST_CASE(inner_join){
+    auto [orders,customers]=write_tables("inner.csv");
+    turbo_csv::join_options options;
+    options.treat_first_record_as_header=true;
+    options.thread_count=4;
+    options.batch_size=64;
+    turbo_csv::joiner csv_joiner(1,0,options);
+
+    auto results=collect(csv_joiner,orders,customers);
+
+    // 1000 orders belong to existing customers, the 10 orders of customer 7 match twice
+    BOOST_REQUIRE_EQUAL(1010,results.size());
+    BOOST_REQUIRE_EQUAL(0,results.count(100));
+    BOOST_REQUIRE_EQUAL(2,results.count(127));
+    BOOST_REQUIRE_EQUAL("\"customer 5\"",results.find(245)->second);
+}
+
+BOOST_AUTO_TEST_CASE(left_join){
+    auto [orders,customers]=write_tables("left.csv");
+    turbo_csv::join_options options;
+    options.kind=turbo_csv::join_kind::left;
+    options.treat_first_record_as_header=true;
+    turbo_csv::joiner csv_joiner(1,0,options);
+
+    auto results=collect(csv_joiner,orders,customers);
+
+    BOOST_REQUIRE_EQUAL(1210,results.size());
+    BOOST_REQUIRE_EQUAL(1,results.count(100));
+    BOOST_REQUIRE_EQUAL("",results.find(100)->second);
+}
+
+BOOST_AUTO_TEST_CASE(spilled_join_matches_in_memory_join){
+    auto [orders,customers]=write_tables("spilled.csv");
+    turbo_csv::join_options options;
+    options.kind=turbo_csv::join_kind::left;
+    options.treat_first_record_as_header=true;
+    turbo_csv::joiner in_memory_joiner(1,0,options);
+    auto expected=collect(in_memory_joiner,orders,customers);
+
+    // A budget of a few records forces the partitioned join
+    options.memory_budget=1024;
+    options.partition_count=8;
+    turbo_csv::joiner spilling_joiner(1,0,options);
+    auto results=collect(spilling_joiner,orders,customers);
+
+    BOOST_REQUIRE(expected==results);
+    for(auto& entry:std::filesystem::directory_iterator(options.temp_directory)){
+        BOOST_REQUIRE(entry.path().filename().string().rfind("turbo_csv_join_",0)!=0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(oversized_partitions_partitioned_again){
+    auto [orders,customers]=write_tables("repartitioned.csv");
+    // Customer 7 gets enough records to exceed the budget on its own
+    {
+        std::ofstream customer_file(customers,std::ios::app);
+        for(int copy=0;copy<50;copy++){customer_file<<"7,\"customer 7, copy "<<copy<<"\"\n";}
+    }
+    turbo_csv::join_options options;
+    options.treat_first_record_as_header=true;
+    turbo_csv::joiner in_memory_joiner(1,0,options);
+    auto expected=collect(in_memory_joiner,orders,customers);
+
+    // Two partitions of about 50 customers each exceed the budget, they are partitioned until they fit
+    options.memory_budget=2048;
+    options.partition_count=2;
+    turbo_csv::joiner spilling_joiner(1,0,options);
+    auto results=collect(spilling_joiner,orders,customers);
+
+    BOOST_REQUIRE_EQUAL(99*10+52*10,results.size());
+    BOOST_REQUIRE(expected==results);
+    for(auto& entry:std::filesystem::directory_iterator(options.temp_directory)){
+        BOOST_REQUIRE(entry.path().filename().string().rfind("turbo_csv_join_",0)!=0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(join_into_writer){
+    auto [orders,customers]=write_tables("writer.csv");
+    turbo_csv::testing::temp_file output("hash_join","output.csv");
+    turbo_csv::join_options options;
+    options.kind=turbo_csv::join_kind::left;
+    options.treat_first_record_as_header=true;
+    turbo_csv::joiner csv_joiner(1,0,options);
+    {
+        turbo_csv::basic_writer<turbo_csv::dialect> csv_writer(output);
+        csv_joiner.join_into(orders,customers,csv_writer);
+    }
+
+    turbo_csv::reader csv_reader(output,true);
+    BOOST_REQUIRE_EQUAL(4,csv_reader.get_indexof("name"));
+    std::size_t records=0,unmatched=0;
+    for(auto& record:csv_reader.stream()){
+        BOOST_REQUIRE_EQUAL(5,record.get_field_count());
+        if(record[4].empty()){unmatched++;}
+        records++;
+    }
+    BOOST_REQUIRE_EQUAL(1210,records);
+    BOOST_REQUIRE_EQUAL(200,unmatched);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,91 @@
+#define BOOST_TEST_MODULE multi_reader_test
+
+#include<multi_reader.hpp>
+#include<csv_file_reader.hpp>
+#include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
+#include<fstream>
+
+
+// Writes shard_count shards each containing a header and rows_per_shard rows "shard,row"
+auto write_shards(const std::string& prefix,int shard_count,int rows_per_shard){
+    std::vector<turbo_csv::testing::temp_file> shards;
+    for(int shard=0;shard<shard_count;shard++){
+        shards.emplace_back("multi_reader",prefix+"-"+std::to_string(shard)+".csv");
+        std::ofstream file(shards.back().get_path());
+        file<<"shard,row\n";
+        for(int row=0;row<rows_per_shard;row++){
+            file<<shard<<","<<row<<"\n";
+        }
+    }
+    return shards;
+}
+
+auto shard_paths(const std::vector<turbo_csv::testing::temp_file>& shards){
+    return std::vector<std::string>(shards.begin(),shards.end());
+}
+
+BOOST_AUTO_TEST_SUITE(multi_reader_methods)
+
+BOOST_AUTO_TEST_CASE(glob_paths){
+    auto shards=write_shards("glob",3,1);
+    auto paths=shard_paths(shards);
+
+    auto matched=turbo_csv::glob_paths((std::filesystem::temp_directory_path()/"turbo_csv_multi_reader_glob-*.csv").string());
+
+    BOOST_REQUIRE_EQUAL_COLLECTIONS(paths.begin(),paths.end(),matched.begin(),matched.end());
+}
+
+BOOST_AUTO_TEST_CASE(ordered_merge){
+    auto shards=write_shards("ordered",5,1000);
+    auto paths=shard_paths(shards);
+    turbo_csv::multi_reader csv_reader(paths,true,turbo_csv::merge_order::ordered,3,64);
+    turbo_csv::basic_record<turbo_csv::dialect> rec;
+
+    int expected_shard=0,expected_row=0;
+    while(csv_reader.next(rec)){
+        BOOST_REQUIRE_EQUAL(expected_shard,rec.get_field<int>(0));
+        BOOST_REQUIRE_EQUAL(expected_row,rec.get_field<int>(1));
+        if(++expected_row==1000){expected_row=0;expected_shard++;}
+    }
+
+    BOOST_REQUIRE_EQUAL(5,expected_shard);
+    BOOST_REQUIRE_EQUAL(1,csv_reader.get_indexof("row"));
+}
+
+BOOST_AUTO_TEST_CASE(unordered_merge){
+    auto shards=write_shards("unordered",5,1000);
+    auto paths=shard_paths(shards);
+    turbo_csv::basic_multi_reader<turbo_csv::parser,turbo_csv::file_reader<4096>,turbo_csv::dialect>
+        csv_reader(paths,true,turbo_csv::merge_order::unordered,3,64);
+    turbo_csv::multi_reader::record_batch batch;
+
+    std::vector<int> rows_per_shard(5,0);
+    long long row_sum=0;
+    while(csv_reader.next_batch(batch)){
+        for(auto& rec:batch){
+            rows_per_shard.at(rec.get_field<int>(0))++;
+            row_sum+=rec.get_field<int>(1);
+        }
+    }
+
+    for(auto rows:rows_per_shard){
+        BOOST_REQUIRE_EQUAL(1000,rows);
+    }
+    BOOST_REQUIRE_EQUAL(5*(999*1000/2),row_sum);
+}
+
+BOOST_AUTO_TEST_CASE(header_mismatch_throws){
+    auto shards=write_shards("mismatch",2,10);
+    auto paths=shard_paths(shards);
+    {
+        std::ofstream file(paths.back());
+        file<<"shard,line\n1,0\n";
+    }
+    turbo_csv::multi_reader csv_reader(paths,true);
+    turbo_csv::basic_record<turbo_csv::dialect> rec;
+
+    BOOST_REQUIRE_THROW(while(csv_reader.next(rec));,std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
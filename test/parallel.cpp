@@ -0,0 +1,104 @@
+#define BOOST_TEST_MODULE parallel_test
+
+#include<turbo_csv.hpp>
+#include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
+#include<filesystem>
+#include<fstream>
+#include<atomic>
+#include<set>
+
+
+BOOST_AUTO_TEST_SUITE(work_stealing_queues)
+
+BOOST_AUTO_TEST_CASE(idle_worker_steals_from_other_queues){
+    turbo_csv::work_stealing_queues<int> queues(2,8);
+    queues.push(0,1);
+    queues.push(0,2);
+    queues.push(0,3);
+
+    // The owner takes its oldest item, a thief takes the newest one
+    BOOST_REQUIRE_EQUAL(1,queues.pop(0).value());
+    BOOST_REQUIRE_EQUAL(3,queues.pop(1).value());
+    BOOST_REQUIRE_EQUAL(2,queues.pop(1).value());
+
+    queues.close();
+    BOOST_REQUIRE(!queues.pop(0).has_value());
+    BOOST_REQUIRE(!queues.push(1,4));
+}
+
+BOOST_AUTO_TEST_CASE(push_blocks_once_queues_are_full){
+    turbo_csv::work_stealing_queues<int> queues(2,2);
+    queues.push(0,1);
+    queues.push(1,2);
+
+    std::atomic<bool> pushed=false;
+    std::thread producer([&](){
+        queues.push(0,3);
+        pushed=true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    BOOST_REQUIRE(!pushed);
+
+    BOOST_REQUIRE_EQUAL(2,queues.pop(1).value());
+    producer.join();
+    BOOST_REQUIRE(pushed);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(for_each_parallel)
+
+BOOST_AUTO_TEST_CASE(records_visited_once_from_several_threads){
+    auto path=turbo_csv::testing::write_amounts("parallel","visited.csv",20000);
+    turbo_csv::reader csv_reader(path,true);
+
+    std::atomic<std::size_t> visited=0;
+    std::mutex ids_resx;
+    std::set<std::size_t> ids;
+    csv_reader.for_each_parallel([&](turbo_csv::basic_record<turbo_csv::dialect>& record){
+        visited++;
+        std::lock_guard<std::mutex> lck(ids_resx);
+        ids.insert(record.get_field<std::size_t>(0));
+    },4);
+
+    BOOST_REQUIRE_EQUAL(20000,visited);
+    BOOST_REQUIRE_EQUAL(20000,ids.size());
+    // Records are not retained by the reader
+    BOOST_REQUIRE_EQUAL(1,csv_reader.get_active_recordcount());
+}
+
+BOOST_AUTO_TEST_CASE(thread_local_states_combined){
+    auto path=turbo_csv::testing::write_amounts("parallel","combined.csv",30000);
+    turbo_csv::reader csv_reader(path,true);
+
+    turbo_csv::parallel_options options;
+    options.thread_count=3;
+    options.batch_size=100;
+    options.max_pending_batches=1;
+
+    auto sum=csv_reader.for_each_parallel(std::size_t(0),
+        [](std::size_t& partial,turbo_csv::basic_record<turbo_csv::dialect>& record){partial+=record.get_field<std::size_t>(1);},
+        [](std::size_t& combined,std::size_t&& partial){combined+=partial;},options);
+    BOOST_REQUIRE_EQUAL(300*4950,sum);
+}
+
+BOOST_AUTO_TEST_CASE(batch_callbacks_and_errors){
+    auto path=turbo_csv::testing::write_amounts("parallel","batches.csv",1000);
+    turbo_csv::reader batch_reader(path,true);
+
+    turbo_csv::parallel_options options;
+    options.thread_count=2;
+    options.batch_size=64;
+    auto largest_batch=batch_reader.for_each_parallel(std::size_t(0),
+        [](std::size_t& largest,std::vector<turbo_csv::basic_record<turbo_csv::dialect>>& batch){largest=std::max(largest,batch.size());},
+        [](std::size_t& combined,std::size_t&& partial){combined=std::max(combined,partial);},options);
+    BOOST_REQUIRE_EQUAL(64,largest_batch);
+
+    turbo_csv::reader failing_reader(path,true);
+    BOOST_REQUIRE_THROW(failing_reader.for_each_parallel([](turbo_csv::basic_record<turbo_csv::dialect>& record){
+        if(record.get_field<int>(0)==500){throw std::runtime_error("bad record");}
+    },2),std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
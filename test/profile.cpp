@@ -0,0 +1,91 @@
+#define BOOST_TEST_MODULE profile_test
+
+#include<profile.hpp>
+#include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
+#include<filesystem>
+#include<fstream>
+
+
+// Writes rows "id,user,amount" where user repeats every 5000 rows and every 10th amount is empty
+auto write_events(const std::string& name,int rows){
+    turbo_csv::testing::temp_file path("profile",name);
+    std::ofstream file(path.get_path());
+    file<<"id,user,amount\n";
+    for(int row=0;row<rows;row++){
+        file<<row<<",\"user"<<row%5000<<"\",";
+        if(row%10!=0){file<<row;}
+        file<<"\n";
+    }
+    return path;
+}
+
+BOOST_AUTO_TEST_SUITE(sketches)
+
+BOOST_AUTO_TEST_CASE(hyperloglog_estimates_distinct_values){
+    turbo_csv::hyperloglog distinct,first_half,second_half;
+    for(int value=0;value<100000;value++){
+        auto field=std::to_string(value);
+        distinct.add(field);
+        distinct.add(field);
+        (value<50000 ? first_half : second_half).add(field);
+    }
+    BOOST_CHECK_CLOSE(100000.0,distinct.estimate(),5);
+
+    first_half.merge(second_half);
+    BOOST_REQUIRE_EQUAL(distinct.estimate(),first_half.estimate());
+
+    turbo_csv::hyperloglog small;
+    for(int value=0;value<100;value++){small.add(std::to_string(value));}
+    BOOST_CHECK_CLOSE(100.0,small.estimate(),3);
+}
+
+BOOST_AUTO_TEST_CASE(tdigest_estimates_quantiles){
+    turbo_csv::tdigest digest,odd;
+    for(int value=1;value<=100000;value++){
+        (value%2 ? odd : digest).add(value);
+    }
+    digest.merge(odd);
+
+    BOOST_REQUIRE_EQUAL(100000,digest.count());
+    BOOST_CHECK_CLOSE(50000.0,digest.quantile(0.5),1);
+    BOOST_CHECK_CLOSE(99000.0,digest.quantile(0.99),0.2);
+    BOOST_CHECK_CLOSE(1000.0,digest.quantile(0.01),5);
+    BOOST_REQUIRE_EQUAL(1,digest.quantile(0));
+    BOOST_REQUIRE_EQUAL(100000,digest.quantile(1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(profile_columns)
+
+BOOST_AUTO_TEST_CASE(columns_profiled_in_parallel){
+    auto path=write_events("parallel.csv",50000);
+    turbo_csv::reader csv_reader(path,true);
+
+    auto profiles=turbo_csv::profile_columns(csv_reader,{1,2,5},{},4,256);
+
+    BOOST_REQUIRE_EQUAL(3,profiles.size());
+    // Records are not retained by the reader
+    BOOST_REQUIRE_EQUAL(1,csv_reader.get_active_recordcount());
+
+    auto& users=profiles[0];
+    BOOST_REQUIRE_EQUAL(50000,users.value_count);
+    BOOST_REQUIRE_EQUAL(0,users.numeric_count);
+    BOOST_REQUIRE_EQUAL("user0",users.min);
+    BOOST_REQUIRE_EQUAL("user999",users.max);
+    BOOST_CHECK_CLOSE(5000.0,users.approximate_distinct(),5);
+
+    auto& amounts=profiles[1];
+    BOOST_REQUIRE_EQUAL(5000,amounts.null_count);
+    BOOST_REQUIRE_EQUAL(45000,amounts.numeric_count);
+    BOOST_REQUIRE_EQUAL(1,amounts.numeric_min);
+    BOOST_REQUIRE_EQUAL(49999,amounts.numeric_max);
+    BOOST_CHECK_CLOSE(25000.0,amounts.quantile(0.5),1);
+
+    // Missing columns are null in every record
+    BOOST_REQUIRE_EQUAL(50000,profiles[2].null_count);
+    BOOST_REQUIRE(std::isnan(profiles[2].quantile(0.5)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
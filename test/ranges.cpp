@@ -0,0 +1,85 @@
+#define BOOST_TEST_MODULE ranges_test
+
+#include<turbo_csv.hpp>
+#include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
+#include<filesystem>
+#include<fstream>
+#include<ranges>
+
+
+// Writes rows "id,name" where name is quoted and holds doubled quotes on every 10th row
+auto write_names(const std::string& name,int rows){
+    turbo_csv::testing::temp_file path("ranges",name);
+    std::ofstream file(path.get_path());
+    file<<"id,name\n";
+    for(int row=0;row<rows;row++){
+        file<<row<<",";
+        if(row%10==0){file<<"\"say \"\"hi\"\" "<<row<<"\"";}
+        else{file<<"name"<<row;}
+        file<<"\n";
+    }
+    return path;
+}
+
+using record_view=turbo_csv::reader::record_view;
+static_assert(std::ranges::input_range<record_view>);
+static_assert(std::ranges::view<record_view>);
+static_assert(std::input_iterator<std::ranges::iterator_t<record_view>>);
+
+BOOST_AUTO_TEST_SUITE(record_ranges)
+
+BOOST_AUTO_TEST_CASE(take_stops_reading_early){
+    auto path=write_names("take.csv",1000);
+    turbo_csv::reader csv_reader(path,true);
+
+    std::vector<int> ids;
+    for(auto& record: csv_reader.record_range()|std::views::take(10)){
+        ids.push_back(record.get_field<int>(0));
+    }
+    BOOST_REQUIRE_EQUAL(10,ids.size());
+    BOOST_REQUIRE_EQUAL(9,ids.back());
+
+    // Neither the records read nor the one after them were retained or consumed
+    BOOST_REQUIRE_EQUAL(1,csv_reader.get_active_recordcount());
+    BOOST_REQUIRE_EQUAL(10,csv_reader.next().get_field<int>(0));
+}
+
+BOOST_AUTO_TEST_CASE(views_compose){
+    auto path=write_names("compose.csv",1000);
+    turbo_csv::experimental_reader csv_reader(path,true);
+
+    auto quoted_ids=csv_reader.record_range()
+        |std::views::filter([](auto& record){return record.get_fields()[1].front()=='"';})
+        |std::views::transform([](auto& record){return record.template get_field<int>(0);})
+        |std::views::take(5);
+
+    std::vector<int> ids;
+    std::ranges::copy(quoted_ids,std::back_inserter(ids));
+    BOOST_REQUIRE(ids==std::vector<int>({0,10,20,30,40}));
+
+    // Incrementing past the 5th match makes filter look for the next one ( id 50 ), nothing beyond it is read
+    std::size_t remaining=0;
+    for([[maybe_unused]] auto& record: csv_reader.record_range()){remaining++;}
+    BOOST_REQUIRE_EQUAL(1000-51,remaining);
+}
+
+BOOST_AUTO_TEST_CASE(field_ranges){
+    auto path=write_names("fields.csv",20);
+    turbo_csv::reader csv_reader(path,true);
+    auto& record=csv_reader.next();
+
+    static_assert(std::ranges::contiguous_range<decltype(record.field_range())>);
+    BOOST_REQUIRE_EQUAL(2,std::ranges::distance(record.field_range()));
+    BOOST_REQUIRE_EQUAL("\"say \"\"hi\"\" 0\"",record.field_range()[1]);
+
+    auto unescaped=record.unescaped_field_range();
+    std::vector<std::string_view> fields(unescaped.begin(),unescaped.end());
+    BOOST_REQUIRE_EQUAL("0",fields[0]);
+    BOOST_REQUIRE_EQUAL("say \"hi\" 0",fields[1]);
+
+    auto lengths=record.unescaped_field_range()|std::views::transform([](std::string_view field){return field.size();});
+    BOOST_REQUIRE_EQUAL(10,*std::ranges::max_element(lengths));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
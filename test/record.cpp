@@ -61,6 +61,19 @@ BOOST_AUTO_TEST_CASE(get_converted_field_value_trimmed_double_quotes){
     BOOST_REQUIRE_EQUAL(2014,rec.get_field<int>(0,true,true));
 }
 
+BOOST_AUTO_TEST_CASE(copied_and_moved_record_fields){
+    record rec("2014,Ford,Fiesta Classic with a name long enough to live on the heap,1.6");
+    rec.get_fields();
+
+    record copied(rec);
+    record moved(std::move(rec));
+
+    BOOST_REQUIRE_EQUAL("Ford",copied[1]);
+    BOOST_REQUIRE_EQUAL("Ford",moved[1]);
+    BOOST_REQUIRE_EQUAL(4,moved.get_field_count());
+    BOOST_ASSERT(rec.is_empty());
+}
+
 BOOST_AUTO_TEST_CASE(record_is_empty){
     record rec("");
 
@@ -94,6 +107,42 @@ BOOST_AUTO_TEST_CASE(embedded_comma_dbl_quote){
     BOOST_REQUIRE_EQUAL("Super, fast car",rec.get_field<std::string>(3,true,true));
 }
 
+BOOST_AUTO_TEST_CASE(deprecated_int_escape_positions){
+    std::vector<int> positions{25,42};
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    record rec("2014,Ford,Fiesta Classic,\"Super, fast car\"",positions);
+#pragma GCC diagnostic pop
+
+    BOOST_REQUIRE_EQUAL(4,rec.get_field_count());
+    BOOST_REQUIRE_EQUAL("Super, fast car",rec.get_field<std::string>(3,true,true));
+}
+
+BOOST_AUTO_TEST_CASE(quoted_field_beyond_64kb){
+    std::string long_field(70000,'x');
+    std::string raw="2014,\""+long_field+",x\",\"Super, fast car\"";
+    auto last_quote=raw.size()-1;
+    record rec(raw,{5,70008,70010,last_quote});
+
+    BOOST_REQUIRE_EQUAL(3,rec.get_field_count());
+    BOOST_REQUIRE_EQUAL(long_field+",x",rec.get_field<std::string>(1,true,true));
+    BOOST_REQUIRE_EQUAL("Super, fast car",rec.get_field<std::string>(2,true,true));
+}
+
+BOOST_AUTO_TEST_CASE(doubled_quotes_unescaped){
+    record rec("2014,\"The \"\"best\"\" one\",\"Super, fast car\",Ford",{5,10,11,16,17,22,24,40});
+
+    BOOST_REQUIRE_EQUAL(4,rec.get_field_count());
+    BOOST_REQUIRE_EQUAL("2014",rec.get_unescaped_field(0));
+    BOOST_REQUIRE_EQUAL("The \"best\" one",rec.get_unescaped_field(1));
+    BOOST_REQUIRE_EQUAL("Super, fast car",rec.get_unescaped_field(2));
+    BOOST_REQUIRE_EQUAL("Ford",rec.get_unescaped_field(3));
+    // Decoded once, the same view is handed out again
+    BOOST_REQUIRE(rec.get_unescaped_field(1).data()==rec.get_unescaped_field(1).data());
+    // Fields without doubled quotes are not copied
+    BOOST_REQUIRE(rec.get_unescaped_field(2).data()==rec[2].data()+1);
+}
+
 BOOST_AUTO_TEST_CASE(spaces_preserved){
     record rec("2014, \"Ford\" ,1.6",{6,11});
 
@@ -0,0 +1,93 @@
+#define BOOST_TEST_MODULE shared_file_test
+
+#include<shared_file.hpp>
+#include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
+#include<filesystem>
+#include<fstream>
+#include<thread>
+
+
+// Writes rows "id,comment" where every 7th comment is quoted and spans two lines
+auto write_comments(const std::string& name,int rows){
+    turbo_csv::testing::temp_file path("shared_file",name);
+    std::ofstream file(path.get_path());
+    file<<"id,comment\n";
+    for(int row=0;row<rows;row++){
+        file<<row<<",";
+        if(row%7==0){file<<"\"first line\nsecond, line "<<row<<"\"";}
+        else{file<<"comment"<<row;}
+        file<<"\n";
+    }
+    return path;
+}
+
+BOOST_AUTO_TEST_SUITE(shared_file)
+
+BOOST_AUTO_TEST_CASE(rows_indexed_once){
+    auto path=write_comments("index.csv",100);
+    turbo_csv::shared_file csv_file(path,true);
+
+    BOOST_REQUIRE_EQUAL(100,csv_file.get_rowcount());
+    BOOST_REQUIRE_EQUAL(1,csv_file.get_indexof("comment"));
+    BOOST_REQUIRE_EQUAL(std::string("id,comment\n").size(),csv_file.get_offset(0));
+    BOOST_REQUIRE_EQUAL(std::filesystem::file_size(path),csv_file.get_offset(100));
+    BOOST_REQUIRE_EQUAL(101*sizeof(std::uint64_t),csv_file.memory_size());
+
+    // A cursor starts right at a row holding a quoted record seperator
+    auto cursor=csv_file.cursor(14,16);
+    turbo_csv::basic_record<turbo_csv::dialect> record;
+    BOOST_REQUIRE(cursor.next(record));
+    BOOST_REQUIRE_EQUAL(14,record.get_field<int>(0));
+    BOOST_REQUIRE_EQUAL("\"first line\nsecond, line 14\"",record.get_fields()[1]);
+    BOOST_REQUIRE(cursor.next(record));
+    BOOST_REQUIRE_EQUAL(15,record.get_field<int>(0));
+    BOOST_REQUIRE(!cursor.next(record));
+    BOOST_REQUIRE_EQUAL(16,cursor.get_row());
+
+    // Ranges beyond the file are empty
+    auto past_end=csv_file.cursor(500,600);
+    BOOST_REQUIRE(!past_end.next(record));
+}
+
+BOOST_AUTO_TEST_CASE(disjoint_ranges_read_concurrently){
+    auto path=write_comments("concurrent.csv",40000);
+    turbo_csv::shared_file csv_file(path,true);
+
+    constexpr std::size_t thread_count=4;
+    std::vector<std::size_t> read_rows(thread_count,0);
+    std::vector<char> in_order(thread_count,true);
+    std::vector<std::thread> threads;
+    for(std::size_t thread_index=0;thread_index<thread_count;thread_index++){
+        threads.emplace_back([&,thread_index](){
+            auto first_row=thread_index*10000;
+            auto cursor=csv_file.cursor(first_row,first_row+10000);
+            turbo_csv::basic_record<turbo_csv::dialect> record;
+            while(cursor.next(record)){
+                in_order[thread_index]=in_order[thread_index]&&record.get_field<std::size_t>(0)==first_row+read_rows[thread_index];
+                read_rows[thread_index]++;
+            }
+        });
+    }
+    for(auto& thread: threads){thread.join();}
+
+    for(std::size_t thread_index=0;thread_index<thread_count;thread_index++){
+        BOOST_REQUIRE_EQUAL(10000,read_rows[thread_index]);
+        BOOST_REQUIRE(in_order[thread_index]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(empty_file){
+    turbo_csv::testing::temp_file path("shared_file","empty.csv");
+    std::ofstream(path.get_path()).close();
+
+    turbo_csv::shared_file csv_file(path);
+    BOOST_REQUIRE_EQUAL(0,csv_file.get_rowcount());
+    turbo_csv::basic_record<turbo_csv::dialect> record;
+    auto cursor=csv_file.cursor();
+    BOOST_REQUIRE(!cursor.next(record));
+
+    BOOST_REQUIRE_THROW(turbo_csv::shared_file("turbo_csv_shared_file_missing.csv"),std::system_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
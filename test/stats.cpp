@@ -0,0 +1,64 @@
+#define BOOST_TEST_MODULE stats_test
+
+#include<turbo_csv.hpp>
+#include<boost/test/unit_test.hpp>
+
+
+auto get_examples_dir() {
+    return std::string(EXAMPLES);
+}
+
+BOOST_AUTO_TEST_SUITE(pipeline_stats)
+
+BOOST_AUTO_TEST_CASE(disabled_counters_are_empty){
+    BOOST_CHECK(std::is_empty_v<turbo_csv::basic_stats_counter<false>>);
+    BOOST_CHECK(std::is_empty_v<turbo_csv::basic_shared_stats_counter<false>>);
+    turbo_csv::basic_stats_counter<false> counter;
+    counter.add(10);
+    BOOST_CHECK_EQUAL(counter.get(),0);
+}
+
+BOOST_AUTO_TEST_CASE(stats_only_collected_by_stats_readers){
+    BOOST_CHECK(turbo_csv::collects_stats<turbo_csv::stats_adapted_fstream>);
+    BOOST_CHECK(!turbo_csv::collects_stats<turbo_csv::adapted_fstream>);
+    BOOST_CHECK(!turbo_csv::collects_stats<turbo_csv::file_reader<>>);
+
+    // Readers with and without statistics can be used in the same translation unit
+    turbo_csv::reader csv_reader(get_examples_dir()+"cars.csv");
+    csv_reader.get_totalrecords();
+    auto stats=csv_reader.get_stats();
+    BOOST_CHECK_EQUAL(stats.records,0);
+    BOOST_CHECK_EQUAL(stats.bytes_read,0);
+    BOOST_CHECK_EQUAL(stats.deque_size,2);
+}
+
+BOOST_AUTO_TEST_CASE(reader_stats){
+    turbo_csv::stats_reader csv_reader(get_examples_dir()+"cars.csv");
+    csv_reader.get_totalrecords();
+
+    auto stats=csv_reader.get_stats();
+    BOOST_CHECK_EQUAL(stats.records,2);
+    BOOST_CHECK_EQUAL(stats.fields,8);
+    BOOST_CHECK_EQUAL(stats.average_fields_per_record(),4);
+    BOOST_CHECK_EQUAL(stats.bytes_read,58);
+    BOOST_CHECK_EQUAL(stats.deque_size,2);
+    BOOST_CHECK(stats.buffer_growths>0);
+}
+
+BOOST_AUTO_TEST_CASE(experimental_reader_stats){
+    turbo_csv::stats_experimental_reader csv_reader(get_examples_dir()+"annual_enterprise.csv",true);
+    turbo_csv::basic_record<turbo_csv::dialect> record;
+    while(csv_reader.next(record));
+
+    auto stats=csv_reader.get_stats();
+    BOOST_CHECK_EQUAL(stats.bytes_read,std::filesystem::file_size(get_examples_dir()+"annual_enterprise.csv"));
+    BOOST_CHECK_EQUAL(stats.refill_count,2);
+    BOOST_CHECK_EQUAL(stats.average_fields_per_record(),7);
+    BOOST_CHECK_EQUAL(stats.deque_size,1);
+
+    auto json=stats.to_json();
+    BOOST_CHECK(json.front()=='{'&&json.back()=='}');
+    BOOST_CHECK(json.find("\"records\":"+std::to_string(stats.records))!=std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
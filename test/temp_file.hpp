@@ -0,0 +1,74 @@
+#ifndef TEMP_FILE_HPP
+#define TEMP_FILE_HPP
+
+// Files written by the tests into the temp directory. Every file is removed once the test holding it finishes
+
+#include<string>
+#include<fstream>
+#include<utility>
+#include<filesystem>
+#include<system_error>
+
+namespace turbo_csv::testing {
+
+    /**
+     * @brief Path of a file in the temp directory ( turbo_csv_<suite>_<name> ), the file is removed when the
+     * object is destroyed
+     *
+     */
+    class temp_file {
+        std::filesystem::path path;
+    public:
+        temp_file(const std::string& suite, const std::string& name) :
+            path(std::filesystem::temp_directory_path() / ("turbo_csv_" + suite + "_" + name)) {}
+
+        temp_file(temp_file&& other) noexcept :path(std::exchange(other.path, {})) {}
+        temp_file(const temp_file&) = delete;
+        temp_file& operator=(const temp_file&) = delete;
+        temp_file& operator=(temp_file&&) = delete;
+
+        ~temp_file() {
+            if (path.empty()) { return; }
+            std::error_code ignored;
+            std::filesystem::remove(path, ignored);
+        }
+
+        const std::filesystem::path& get_path() const noexcept {
+            return path;
+        }
+
+        // Readers and writers take the path as a std::string, mapped files and std::filesystem as a path
+        operator std::string() const {
+            return path.string();
+        }
+
+        operator const std::filesystem::path&() const noexcept {
+            return path;
+        }
+
+        std::string string() const {
+            return path.string();
+        }
+    };
+
+    /**
+     * @brief Writes rows "id,amount" where amount is id%100
+     *
+     * @param suite name of the test suite
+     * @param name name of the file
+     * @param rows number of rows after the header
+     * @return temp_file written file
+     */
+    inline temp_file write_amounts(const std::string& suite, const std::string& name, int rows) {
+        temp_file path(suite, name);
+        std::ofstream file(path.get_path());
+        file << "id,amount\n";
+        for (int row = 0; row < rows; row++) {
+            file << row << "," << row % 100 << "\n";
+        }
+        return path;
+    }
+
+}
+
+#endif
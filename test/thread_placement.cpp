@@ -0,0 +1,82 @@
+#define BOOST_TEST_MODULE thread_placement_test
+
+#include<turbo_csv.hpp>
+#include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
+#include<filesystem>
+#include<fstream>
+#include<sched.h>
+#include<set>
+
+
+// Cpus the test process may run on
+std::vector<int> allowed_cpus(){
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    sched_getaffinity(0,sizeof(set),&set);
+    std::vector<int> cpus;
+    for(int cpu=0;cpu<CPU_SETSIZE;cpu++){
+        if(CPU_ISSET(cpu,&set)){cpus.push_back(cpu);}
+    }
+    return cpus;
+}
+
+// Restores the default placement once a test is done
+struct placement_reset{
+    ~placement_reset(){turbo_csv::set_thread_placement({});}
+};
+
+BOOST_AUTO_TEST_SUITE(thread_placement)
+
+BOOST_AUTO_TEST_CASE(cpu_lists_parsed){
+    BOOST_REQUIRE(turbo_csv::placement::parse_cpu_list("0-3,8,10-11\n")==std::vector<int>({0,1,2,3,8,10,11}));
+    BOOST_REQUIRE(turbo_csv::placement::parse_cpu_list("").empty());
+}
+
+BOOST_AUTO_TEST_CASE(workers_pinned_to_worker_cpus){
+    placement_reset reset;
+    auto pinned_cpu=allowed_cpus().back();
+    turbo_csv::thread_placement placement;
+    placement.worker_cpus={pinned_cpu};
+    turbo_csv::set_thread_placement(placement);
+
+    auto path=turbo_csv::testing::write_amounts("thread_placement","workers.csv",5000);
+    turbo_csv::reader csv_reader(path,true);
+    std::mutex cpus_resx;
+    std::set<int> worker_cpus;
+    csv_reader.for_each_parallel([&](turbo_csv::basic_record<turbo_csv::dialect>&){
+        std::lock_guard<std::mutex> lck(cpus_resx);
+        worker_cpus.insert(sched_getcpu());
+    },3);
+    BOOST_REQUIRE(worker_cpus==std::set<int>({pinned_cpu}));
+
+    // Columns are deserialized by placed workers as well
+    turbo_csv::reader column_reader(path,true);
+    auto amounts=column_reader.get_column<int>(1);
+    BOOST_REQUIRE_EQUAL(5000,amounts.size());
+    BOOST_REQUIRE_EQUAL(99,amounts[4999]);
+}
+
+BOOST_AUTO_TEST_CASE(helpers_paired_with_creator){
+    placement_reset reset;
+    BOOST_REQUIRE(turbo_csv::placement::helper_placement().get_cpus().empty());
+
+    turbo_csv::thread_placement placement;
+    placement.pair_with_creator=true;
+    turbo_csv::set_thread_placement(placement);
+
+    // The creator is pinned so that it cannot migrate while the placement is captured
+    auto cpus=allowed_cpus();
+    BOOST_REQUIRE(turbo_csv::placement::pin_current_thread({cpus.front()}));
+    auto helper_cpus=turbo_csv::placement::helper_placement().get_cpus();
+    turbo_csv::placement::pin_current_thread(cpus);
+    if(!helper_cpus.empty()){
+        BOOST_REQUIRE(std::find(helper_cpus.begin(),helper_cpus.end(),cpus.front())!=helper_cpus.end());
+    }
+
+    auto path=turbo_csv::testing::write_amounts("thread_placement","helpers.csv",1000);
+    turbo_csv::experimental_reader csv_reader(path,true);
+    BOOST_REQUIRE_EQUAL(1001,csv_reader.get_totalrecords());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
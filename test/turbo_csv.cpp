@@ -3,7 +3,10 @@
 #include<turbo_csv.hpp>
 #include<csv_file_reader.hpp>
 #include<dialect.hpp>
+#include<filesystem>
+#include<fstream>
 #include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
 
 
 auto get_examples_dir() {
@@ -98,6 +101,187 @@ BOOST_AUTO_TEST_CASE(get_column){
     );
 }
 
+BOOST_AUTO_TEST_CASE(get_column_of_empty_file){
+    turbo_csv::testing::temp_file path("reader","empty.csv");
+    std::ofstream(path.get_path());
+    turbo_csv::reader csv_reader(path,true);
+
+    BOOST_REQUIRE(csv_reader.get_column<int>(0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(next_refills_record){
+    turbo_csv::reader csv_reader(get_examples_dir()+"cars.csv");
+    turbo_csv::basic_record<turbo_csv::dialect> rec;
+
+    BOOST_REQUIRE(csv_reader.next(rec));
+    BOOST_REQUIRE_EQUAL("Ford", rec[1]);
+
+    BOOST_REQUIRE(csv_reader.next(rec));
+    BOOST_REQUIRE_EQUAL("Maruti Suzuki", rec[1]);
+
+    BOOST_REQUIRE(!csv_reader.next(rec));
+    BOOST_ASSERT(rec.is_empty());
+    BOOST_REQUIRE_EQUAL(0,csv_reader.get_active_recordcount());
+}
+
+BOOST_AUTO_TEST_CASE(stream_records){
+    turbo_csv::reader csv_reader(get_examples_dir()+"cars.csv");
+    std::vector<std::string> expected_brands{ "Ford","Maruti Suzuki" };
+    std::vector<std::string> brands;
+
+    for(auto& rec: csv_reader.stream()){
+        brands.emplace_back(rec[1]);
+    }
+
+    BOOST_REQUIRE_EQUAL_COLLECTIONS(expected_brands.begin(), expected_brands.end(),
+        brands.begin(), brands.end()
+    );
+    BOOST_REQUIRE_EQUAL(0,csv_reader.get_active_recordcount());
+}
+
+BOOST_AUTO_TEST_CASE(checkpoint_and_resume){
+    turbo_csv::reader csv_reader(get_examples_dir()+"annual_enterprise.csv",true);
+    csv_reader.next();
+    auto position=csv_reader.checkpoint();
+    auto expected_record=csv_reader.next();
+
+    turbo_csv::reader resumed_reader(get_examples_dir()+"annual_enterprise.csv");
+    resumed_reader.open_at(position);
+    auto resumed_record=resumed_reader.next();
+
+    BOOST_REQUIRE(!position.in_quotes);
+    BOOST_REQUIRE_EQUAL(expected_record.get_raw_size(),resumed_record.get_raw_size());
+    BOOST_REQUIRE_EQUAL(expected_record[0],resumed_record[0]);
+    BOOST_REQUIRE_EQUAL(expected_record[5],resumed_record[5]);
+}
+
+BOOST_AUTO_TEST_CASE(resync_inside_quoted_field){
+    turbo_csv::testing::temp_file path("reader","resync.csv");
+    std::string first_record="1,\"quoted\nfield, with \"\"newline\"\"\",a\n";
+    std::ofstream(path.get_path())<<first_record<<"2,\"second\",b\n3,\"third\",c\n";
+
+    turbo_csv::reader csv_reader(path);
+    // Offset right after the quoted record seperator of the first record
+    auto resumed_offset=csv_reader.resync(first_record.find('\n')+1,3);
+
+    BOOST_REQUIRE_EQUAL(first_record.size(),resumed_offset);
+    BOOST_REQUIRE_EQUAL(2,csv_reader.next().get_field<int>(0));
+}
+
+BOOST_AUTO_TEST_CASE(resync_past_the_window){
+    turbo_csv::testing::temp_file path("reader","resync_window.csv");
+    std::string first_record="1,\""+std::string(300,'x')+"\",a\n";
+    std::ofstream(path.get_path())<<first_record<<"2,\"second\",b\n3,\"third\",c";
+
+    // No record boundary within the first windows, scanning goes on until one is found
+    turbo_csv::parser<turbo_csv::adapted_fstream,turbo_csv::dialect> csv_parser(path);
+    BOOST_REQUIRE_EQUAL(first_record.size(),csv_parser.resync(10,3,16));
+    BOOST_REQUIRE_EQUAL(2,csv_parser.next().get_field<int>(0));
+
+    // Nothing but a partial record follows the offset
+    auto end_offset=std::filesystem::file_size(path);
+    BOOST_REQUIRE_EQUAL(end_offset,csv_parser.resync(end_offset-3,3,16));
+    turbo_csv::basic_record<turbo_csv::dialect> record;
+    BOOST_REQUIRE(!csv_parser.next(record));
+}
+
+BOOST_AUTO_TEST_CASE(byte_order_mark_stripped){
+    turbo_csv::testing::temp_file path("reader","bom.csv");
+    std::ofstream(path.get_path(),std::ios::binary)<<"\xEF\xBB\xBFyear,brand\n2014,Ford\n";
+
+    turbo_csv::reader csv_reader(path,true);
+    BOOST_REQUIRE_EQUAL(0,csv_reader.get_indexof("year"));
+    BOOST_REQUIRE_EQUAL("Ford",csv_reader.next()[1]);
+
+    // Resuming from the beginning skips it as well
+    turbo_csv::reader resumed_reader(path);
+    resumed_reader.open_at(turbo_csv::parser_checkpoint{});
+    BOOST_REQUIRE_EQUAL("year",resumed_reader.next()[0]);
+
+    // Bytes only looking like the beginning of a byte order mark are kept
+    std::ofstream(path.get_path(),std::ios::binary)<<"\xEF\xBBx,\"a\nb\"\n2,c\n";
+    turbo_csv::reader partial_reader(path);
+    BOOST_REQUIRE_EQUAL("\xEF\xBBx",partial_reader.next()[0]);
+    BOOST_REQUIRE_EQUAL("2",partial_reader.next()[0]);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_utf8_replaced){
+    turbo_csv::testing::temp_file path("reader","invalid_utf8.csv");
+    std::ofstream(path.get_path(),std::ios::binary)<<"name,city\nJos\xC3\xA9,M\xFCnchen\n";
+
+    turbo_csv::experimental_reader csv_reader(path,true);
+    turbo_csv::utf8_options options;
+    options.action=turbo_csv::utf8_action::replace;
+    csv_reader.set_utf8_options(options);
+
+    auto& record=csv_reader.next();
+    BOOST_REQUIRE_EQUAL("Jos\xC3\xA9",record[0]);
+    BOOST_REQUIRE_EQUAL("M?nchen",record[1]);
+    BOOST_REQUIRE_EQUAL(17,csv_reader.get_first_invalid_utf8_offset().value());
+}
+
+BOOST_AUTO_TEST_CASE(multibyte_seperators){
+    turbo_csv::testing::temp_file path("reader","multibyte.csv");
+    std::ofstream(path.get_path(),std::ios::binary)<<"year||brand\x1f\x1e" "2014||\"Ford||Motor\x1f\x1e" "Company\"\x1f\x1e" "2020||a|b";
+
+    using unit_dialect=turbo_csv::delimited_dialect<"||","\x1f\x1e">;
+    turbo_csv::basic_reader<turbo_csv::parser,turbo_csv::adapted_fstream,unit_dialect> csv_reader(path,true);
+
+    BOOST_REQUIRE_EQUAL(1,csv_reader.get_indexof("brand"));
+    auto& first_record=csv_reader.next();
+    BOOST_REQUIRE_EQUAL(2,first_record.get_field_count());
+    BOOST_REQUIRE_EQUAL("\"Ford||Motor\x1f\x1e" "Company\"",first_record[1]);
+    auto& second_record=csv_reader.next();
+    BOOST_REQUIRE_EQUAL("2020",second_record[0]);
+    BOOST_REQUIRE_EQUAL("a|b",second_record[1]);
+    BOOST_REQUIRE(csv_reader.next().is_empty());
+}
+
+BOOST_AUTO_TEST_CASE(backslash_escaped_quotes){
+    turbo_csv::testing::temp_file path("reader","backslash.csv");
+    std::ofstream(path.get_path(),std::ios::binary)<<"1,\"say \\\"hi\\\", bye\",a\\,b\n2,c,d\n";
+
+    using backslash_dialect=turbo_csv::delimited_dialect<",","\n",'"','\\'>;
+    turbo_csv::basic_reader<turbo_csv::parser,turbo_csv::file_reader<1000000>,backslash_dialect> csv_reader(path);
+
+    auto& first_record=csv_reader.next();
+    BOOST_REQUIRE_EQUAL(3,first_record.get_field_count());
+    BOOST_REQUIRE_EQUAL("\"say \\\"hi\\\", bye\"",first_record[1]);
+    BOOST_REQUIRE_EQUAL("a\\,b",first_record[2]);
+    BOOST_REQUIRE_EQUAL("say \"hi\", bye",first_record.get_unescaped_field(1));
+    BOOST_REQUIRE_EQUAL("a,b",first_record.get_unescaped_field(2));
+    BOOST_REQUIRE_EQUAL("d",csv_reader.next()[2]);
+}
+
+BOOST_AUTO_TEST_CASE(quote_free_buffers_split_without_quote_tracking){
+    turbo_csv::testing::temp_file path("reader","quote_free.csv");
+    {
+        std::ofstream file(path.get_path(),std::ios::binary);
+        for(int row=0;row<20;row++){file<<row<<",Ford,Fiesta,1.6\n";}
+        // Quotes and ignore characters turn up later in the file
+        file<<"20,\"Super, fast\ncar\",\t\"\"\"best\"\"\",1.6\n";
+        for(int row=21;row<40;row++){file<<row<<",Maruti Suzuki,Brezza,1.3\n";}
+        file<<"40,last,record,0";
+    }
+
+    // Buffers smaller than a few records, so that the fast path falls back in the middle of a record
+    turbo_csv::parser<turbo_csv::file_reader<32>,turbo_csv::dialect> buffered_parser(path);
+    turbo_csv::parser<turbo_csv::adapted_fstream,turbo_csv::dialect> byte_parser(path);
+    turbo_csv::basic_record<turbo_csv::dialect> buffered_record,byte_record;
+    int records=0;
+    while(byte_parser.next(byte_record)){
+        BOOST_REQUIRE(buffered_parser.next(buffered_record));
+        BOOST_REQUIRE_EQUAL(byte_record.get_raw_size(),buffered_record.get_raw_size());
+        BOOST_REQUIRE_EQUAL(byte_record.get_field_count(),buffered_record.get_field_count());
+        BOOST_REQUIRE_EQUAL(records,buffered_record.get_field<int>(0));
+        BOOST_REQUIRE_EQUAL(byte_record[1],buffered_record[1]);
+        records++;
+    }
+    BOOST_REQUIRE(!buffered_parser.next(buffered_record));
+    BOOST_REQUIRE_EQUAL(41,records);
+    BOOST_REQUIRE_EQUAL(byte_parser.checkpoint().offset,buffered_parser.checkpoint().offset);
+}
+
 BOOST_AUTO_TEST_CASE(get_index_of_column){
     turbo_csv::reader csv_reader(get_examples_dir()+"business-price-index.csv",true);
 
@@ -211,3 +395,113 @@ BOOST_AUTO_TEST_CASE(get_index_of_column){
 BOOST_AUTO_TEST_SUITE_END()
 
 
+
+BOOST_AUTO_TEST_SUITE(malformed_records)
+
+auto write_malformed(const std::string& name,const std::string& data){
+    turbo_csv::testing::temp_file path("malformed",name);
+    std::ofstream(path.get_path())<<data;
+    return path;
+}
+
+// Line 3 opens a quote that is never closed
+const std::string unbalanced_data="id,name,price\n1,pen,10\n2,\"book,20\n3,ink,30\n4,cap,40\n";
+
+BOOST_AUTO_TEST_CASE(unbalanced_quote_ignored_by_default){
+    auto path=write_malformed("ignore.csv",unbalanced_data);
+    turbo_csv::reader csv_reader(path,true);
+
+    BOOST_REQUIRE_EQUAL(3,csv_reader.get_totalrecords());
+}
+
+BOOST_AUTO_TEST_CASE(unbalanced_quote_skipped_and_reported){
+    auto path=write_malformed("skip.csv",unbalanced_data);
+    turbo_csv::reader csv_reader(path,true);
+    std::vector<turbo_csv::parse_error> errors;
+
+    turbo_csv::parse_options options;
+    options.policy=turbo_csv::error_policy::skip;
+    options.on_error=[&errors](const turbo_csv::parse_error& error){errors.push_back(error);};
+    csv_reader.set_parse_options(options);
+
+    std::vector<int> ids;
+    for(auto& rec:csv_reader.stream()){ids.push_back(rec.get_field<int>(0));}
+
+    std::vector<int> expected_ids{1,3,4};
+    BOOST_REQUIRE_EQUAL_COLLECTIONS(expected_ids.begin(),expected_ids.end(),ids.begin(),ids.end());
+    BOOST_REQUIRE_EQUAL(1,errors.size());
+    BOOST_ASSERT(errors.front().kind==turbo_csv::parse_error::error_kind::unbalanced_quote);
+    BOOST_REQUIRE_EQUAL(3,errors.front().line);
+    BOOST_REQUIRE_EQUAL(unbalanced_data.find("2,"),errors.front().offset);
+}
+
+BOOST_AUTO_TEST_CASE(malformed_records_repaired){
+    auto path=write_malformed("repair.csv","id,name,price\n1,pe\"n,10\n2,\"book,20\n3,ink\n4,cap,40,extra\n");
+    turbo_csv::reader csv_reader(path,true);
+    std::size_t error_count=0;
+
+    turbo_csv::parse_options options;
+    options.policy=turbo_csv::error_policy::repair;
+    options.on_error=[&error_count](const turbo_csv::parse_error&){error_count++;};
+    csv_reader.set_parse_options(options);
+
+    std::vector<std::vector<std::string>> rows;
+    for(auto& rec:csv_reader.stream()){
+        rows.emplace_back(rec.get_fields().begin(),rec.get_fields().end());
+    }
+
+    BOOST_REQUIRE_EQUAL(4,rows.size());
+    BOOST_REQUIRE_EQUAL(4,error_count);
+    BOOST_REQUIRE_EQUAL("pe\"n",rows[0][1]);
+    BOOST_REQUIRE_EQUAL("\"book",rows[1][1]);
+    BOOST_REQUIRE_EQUAL("20",rows[1][2]);
+    BOOST_REQUIRE_EQUAL(3,rows[2].size());
+    BOOST_REQUIRE_EQUAL("",rows[2][2]);
+    BOOST_REQUIRE_EQUAL(3,rows[3].size());
+    BOOST_REQUIRE_EQUAL("40",rows[3][2]);
+}
+
+BOOST_AUTO_TEST_CASE(well_formed_quoted_records_not_reported){
+    auto path=write_malformed("valid.csv","id,name,price\n1,\"pen, blue\",10\n2,\"multi\nline \"\"book\"\"\",20\n");
+    turbo_csv::reader csv_reader(path,true);
+    std::size_t error_count=0;
+
+    turbo_csv::parse_options options;
+    options.policy=turbo_csv::error_policy::report;
+    options.on_error=[&error_count](const turbo_csv::parse_error&){error_count++;};
+    csv_reader.set_parse_options(options);
+
+    BOOST_REQUIRE_EQUAL(3,csv_reader.get_totalrecords());
+    BOOST_REQUIRE_EQUAL(0,error_count);
+    BOOST_REQUIRE_EQUAL("\"pen, blue\"",csv_reader[1][1]);
+}
+
+BOOST_AUTO_TEST_CASE(quote_escaped_quotes_not_reported){
+    // Quotes escaped by a backslash are normal characters, they neither open nor close a quoted field
+    auto path=write_malformed("escaped.csv","id,name,note\n1,\"a\",b\\\"c\n2,\\\"x,\"y\\\"\"\n3,p\"q,r\n4,\"s\"t,u\n");
+    using backslash_dialect=turbo_csv::delimited_dialect<",","\n",'"','\\'>;
+    turbo_csv::basic_reader<turbo_csv::parser,turbo_csv::file_reader<1000000>,backslash_dialect> csv_reader(path,true);
+    std::vector<turbo_csv::parse_error> errors;
+
+    turbo_csv::parse_options options;
+    options.policy=turbo_csv::error_policy::report;
+    options.on_error=[&errors](const turbo_csv::parse_error& error){errors.push_back(error);};
+    csv_reader.set_parse_options(options);
+
+    std::vector<std::vector<std::string>> rows;
+    for(auto& rec:csv_reader.stream()){
+        rows.emplace_back(rec.get_fields().begin(),rec.get_fields().end());
+    }
+
+    BOOST_REQUIRE_EQUAL(4,rows.size());
+    BOOST_REQUIRE_EQUAL("b\\\"c",rows[0][2]);
+    BOOST_REQUIRE_EQUAL("\\\"x",rows[1][1]);
+    BOOST_REQUIRE_EQUAL("\"y\\\"\"",rows[1][2]);
+    // Unescaped stray quotes are still reported
+    BOOST_REQUIRE_EQUAL(2,errors.size());
+    BOOST_REQUIRE_EQUAL(4,errors[0].line);
+    BOOST_REQUIRE_EQUAL(5,errors[1].line);
+    for(auto& error:errors){BOOST_ASSERT(error.kind==turbo_csv::parse_error::error_kind::stray_quote);}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
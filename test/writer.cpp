@@ -0,0 +1,146 @@
+#define BOOST_TEST_MODULE writer_test
+
+#include<turbo_writer.hpp>
+#include<turbo_csv.hpp>
+#include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
+#include<filesystem>
+#include<sstream>
+
+
+auto get_examples_dir() {
+    return std::string(EXAMPLES);
+}
+
+auto output_path(const std::string& name){
+    return turbo_csv::testing::temp_file("writer",name);
+}
+
+auto read_file(const std::string& path){
+    std::ifstream file(path,std::ios::binary);
+    std::stringstream data;
+    data<<file.rdbuf();
+    return data.str();
+}
+
+struct car{
+    int year;
+    std::string brand;
+    double engine;
+};
+
+BOOST_AUTO_TEST_SUITE(writer_methods)
+
+BOOST_AUTO_TEST_CASE(write_record){
+    auto path=output_path("record.csv");
+    {
+        turbo_csv::writer csv_writer(path);
+        csv_writer.write_record(2014,"Ford","Fiesta Classic",1.6);
+        csv_writer.write_record(2020,std::string("Maruti Suzuki"),std::string_view("Brezza"),1.6);
+    }
+
+    BOOST_REQUIRE_EQUAL("2014,Ford,Fiesta Classic,1.6\n2020,Maruti Suzuki,Brezza,1.6\n",read_file(path));
+}
+
+BOOST_AUTO_TEST_CASE(quote_only_when_needed){
+    auto path=output_path("quoted.csv");
+    {
+        turbo_csv::writer csv_writer(path);
+        csv_writer.write_record("Super, fast car","The \"best\" one","two\nlines","plain text longer than sixteen bytes");
+    }
+
+    BOOST_REQUIRE_EQUAL("\"Super, fast car\",\"The \"\"best\"\" one\",\"two\nlines\",plain text longer than sixteen bytes\n",read_file(path));
+}
+
+BOOST_AUTO_TEST_CASE(multibyte_seperators_and_quote_escape){
+    auto path=output_path("delimited.csv");
+    {
+        turbo_csv::basic_writer<turbo_csv::delimited_dialect<"||","\r\n",'"','\\'>> csv_writer(path);
+        csv_writer.write_record(2014,"Ford|Motor","The \"best\" one","back\\slash");
+        csv_writer.write_record("a","b");
+    }
+
+    BOOST_REQUIRE_EQUAL("2014||\"Ford|Motor\"||\"The \\\"best\\\" one\"||\"back\\\\slash\"\r\na||b\r\n",read_file(path));
+}
+
+BOOST_AUTO_TEST_CASE(write_tuple_struct_and_columns){
+    auto path=output_path("tuple.csv");
+    {
+        turbo_csv::writer csv_writer(path);
+        csv_writer.write_tuple(std::make_tuple(2014,"Ford",true));
+        csv_writer.write_struct(car{2020,"Maruti Suzuki",1.5},&car::year,&car::brand,&car::engine);
+
+        std::vector<int> years{2001,2002};
+        std::vector<std::string> brands{"Tata","Honda"};
+        csv_writer.write_columns(years,brands);
+    }
+
+    BOOST_REQUIRE_EQUAL("2014,Ford,1\n2020,Maruti Suzuki,1.5\n2001,Tata\n2002,Honda\n",read_file(path));
+}
+
+BOOST_AUTO_TEST_CASE(round_trip_records){
+    auto path=output_path("round_trip.csv");
+    {
+        turbo_csv::reader csv_reader(get_examples_dir()+"cars.csv");
+        turbo_csv::writer csv_writer(path,128);
+        for(auto& rec:csv_reader.stream()){
+            csv_writer.write(rec);
+        }
+    }
+
+    BOOST_REQUIRE_EQUAL(read_file(get_examples_dir()+"cars.csv")+"\n",read_file(path));
+}
+
+BOOST_AUTO_TEST_CASE(round_trip_ignored_characters){
+    auto path=output_path("ignored.csv");
+    {
+        turbo_csv::writer csv_writer(path);
+        csv_writer.write_record("a\tb","carriage\rreturn","plain");
+    }
+
+    // Tabs are dropped outside quotes by the default dialect, so the field is quoted to keep them
+    BOOST_REQUIRE_EQUAL("\"a\tb\",\"carriage\rreturn\",plain\n",read_file(path));
+    turbo_csv::reader csv_reader(path);
+    turbo_csv::basic_record<turbo_csv::dialect> record;
+    BOOST_REQUIRE(csv_reader.next(record));
+    BOOST_REQUIRE_EQUAL("a\tb",record.get_unescaped_field(0));
+    BOOST_REQUIRE_EQUAL("carriage\rreturn",record.get_unescaped_field(1));
+    BOOST_REQUIRE_EQUAL("plain",record.get_unescaped_field(2));
+}
+
+BOOST_AUTO_TEST_CASE(async_sink_small_buffer){
+    auto path=output_path("async.csv");
+    std::string expected;
+    {
+        turbo_csv::async_writer csv_writer(path,128);
+        for(int row=0;row<1000;row++){
+            csv_writer.write_record(row,row*0.5,"value");
+            expected+=std::to_string(row)+","+boost::lexical_cast<std::string>(row*0.5)+",value\n";
+        }
+    }
+
+    BOOST_REQUIRE_EQUAL(expected,read_file(path));
+}
+
+#ifdef TURBO_CSV_HAS_IO_URING
+BOOST_AUTO_TEST_CASE(uring_sink_small_buffer){
+    auto path=output_path("uring.csv");
+    std::string expected;
+    try{
+        turbo_csv::basic_writer<turbo_csv::dialect,turbo_csv::uring_file_sink> csv_writer(path,128);
+        for(int row=0;row<1000;row++){
+            csv_writer.write_record(row,"value");
+            expected+=std::to_string(row)+",value\n";
+        }
+    }
+    catch(const std::system_error& error){
+        // Kernel might not allow io_uring (containers, seccomp)
+        BOOST_TEST_MESSAGE("io_uring not available: "<<error.what());
+        return;
+    }
+
+    BOOST_REQUIRE_EQUAL(expected,read_file(path));
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,141 @@
+#define BOOST_TEST_MODULE zone_map_test
+
+#include<turbo_csv.hpp>
+#include<zone_map.hpp>
+#include<filesystem>
+#include<fstream>
+#include<boost/test/unit_test.hpp>
+#include"temp_file.hpp"
+
+namespace {
+    // Time ordered log: id,timestamp,level,latency ( latency is empty for every 10th record )
+    turbo_csv::testing::temp_file write_log(const std::string& name){
+        turbo_csv::testing::temp_file path("zone",name);
+        std::ofstream file(path.get_path(),std::ios::binary);
+        file<<"id,timestamp,level,latency\n";
+        for(int id=0;id<1000;id++){
+            file<<id<<",2024-01-"<<(id/100<9 ? "0" : "")<<(id/100+1)<<"T00:00:"<<(id%60<10 ? "0" : "")<<id%60<<","
+                <<(id%3==0 ? "\"warn\"" : "info")<<","<<(id%10==0 ? std::string() : std::to_string(id%50)+".5")<<"\n";
+        }
+        return path;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(zone_map_building)
+
+BOOST_AUTO_TEST_CASE(blocks_summarize_columns){
+    auto path=write_log("blocks.csv");
+    turbo_csv::reader csv_reader(path,true);
+    csv_reader.record_zone_map(100);
+    for(auto& record:csv_reader.stream()){(void)record;}
+
+    const auto& blocks=csv_reader.get_zone_map().get_blocks();
+    BOOST_REQUIRE_EQUAL(10,blocks.size());
+    BOOST_REQUIRE_EQUAL(200,blocks[2].first_record);
+    BOOST_REQUIRE_EQUAL(100,blocks[2].record_count);
+    BOOST_REQUIRE_EQUAL(blocks[1].end_offset,blocks[2].begin.offset);
+    BOOST_REQUIRE_EQUAL(std::filesystem::file_size(path),blocks.back().end_offset);
+
+    const auto& ids=blocks[2].columns[0];
+    BOOST_REQUIRE(ids.numeric);
+    BOOST_REQUIRE_EQUAL(200,ids.numeric_min);
+    BOOST_REQUIRE_EQUAL(299,ids.numeric_max);
+    BOOST_REQUIRE_EQUAL("2024-01-03T00:00:00",blocks[2].columns[1].min);
+    // Enclosing quotes are not part of the values
+    BOOST_REQUIRE_EQUAL("warn",blocks[2].columns[2].max);
+    BOOST_REQUIRE(!blocks[2].columns[2].numeric);
+    BOOST_REQUIRE_EQUAL(10,blocks[2].columns[3].null_count);
+    BOOST_REQUIRE_EQUAL(90,blocks[2].columns[3].value_count);
+}
+
+BOOST_AUTO_TEST_CASE(sidecar_round_trip){
+    auto path=write_log("sidecar.csv");
+    // Written next to the csv file by save
+    turbo_csv::testing::temp_file sidecar("zone","sidecar.csv.zonemap");
+    {
+        turbo_csv::experimental_reader csv_reader(path,true);
+        csv_reader.record_zone_map(100);
+        csv_reader.get_totalrecords();
+        csv_reader.get_zone_map().save(path);
+    }
+
+    auto zones=turbo_csv::zone_map::load(path);
+    BOOST_REQUIRE_EQUAL(10,zones.get_blocks().size());
+    BOOST_REQUIRE_EQUAL(100,zones.get_records_per_block());
+    BOOST_REQUIRE_EQUAL(std::filesystem::file_size(path),zones.get_file_size());
+    BOOST_REQUIRE_EQUAL("2024-01-10T00:00:59",zones.get_blocks().back().columns[1].max);
+
+    // Sidecars of files that changed are rejected
+    std::ofstream(path.get_path(),std::ios::binary|std::ios::app)<<"1000,2024-01-11T00:00:00,info,1.5\n";
+    BOOST_REQUIRE_THROW(turbo_csv::zone_map::load(path),std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(stale_sidecars_rejected){
+    auto path=write_log("stale.csv");
+    // Written next to the csv file by save
+    turbo_csv::testing::temp_file sidecar("zone","stale.csv.zonemap");
+    {
+        turbo_csv::reader csv_reader(path,true);
+        csv_reader.record_zone_map(100);
+        csv_reader.get_totalrecords();
+        csv_reader.get_zone_map().save(path);
+    }
+    auto saved_time=std::filesystem::last_write_time(path);
+    BOOST_REQUIRE_NO_THROW(turbo_csv::zone_map::load(path));
+
+    // Same size and content, newer modification time
+    std::filesystem::last_write_time(path,saved_time+std::chrono::seconds(1));
+    BOOST_REQUIRE_THROW(turbo_csv::zone_map::load(path),std::runtime_error);
+
+    // Same size and modification time, different last record
+    {
+        std::fstream file(path.get_path(),std::ios::binary|std::ios::in|std::ios::out);
+        file.seekp(-4,std::ios::end);
+        file<<"8.5\n";
+    }
+    std::filesystem::last_write_time(path,saved_time);
+    BOOST_REQUIRE_THROW(turbo_csv::zone_map::load(path),std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(filtered_reads)
+
+BOOST_AUTO_TEST_CASE(numeric_filter_skips_blocks){
+    auto path=write_log("numeric.csv");
+    turbo_csv::reader csv_reader(path,true);
+    csv_reader.record_zone_map(100);
+    csv_reader.get_totalrecords();
+    auto zones=csv_reader.get_zone_map();
+
+    turbo_csv::reader filtered_reader(path,true);
+    int matching=0;
+    auto blocks_read=filtered_reader.for_each_matching(zones,0,turbo_csv::zone_op::greater,950,[&](auto& record){
+        if(record.template get_field<int>(0)>950){matching++;}
+    });
+    BOOST_REQUIRE_EQUAL(1,blocks_read);
+    BOOST_REQUIRE_EQUAL(49,matching);
+}
+
+BOOST_AUTO_TEST_CASE(string_filter_reads_recent_blocks){
+    auto path=write_log("recent.csv");
+    turbo_csv::reader csv_reader(path,true);
+    csv_reader.record_zone_map(100);
+    csv_reader.get_totalrecords();
+    auto zones=csv_reader.get_zone_map();
+
+    turbo_csv::experimental_reader filtered_reader(path,true);
+    int records=0,first_id=-1;
+    auto blocks_read=filtered_reader.for_each_matching(zones,1,turbo_csv::zone_op::greater_equal,std::string("2024-01-09"),[&](auto& record){
+        if(first_id<0){first_id=record.template get_field<int>(0);}
+        records++;
+    });
+    BOOST_REQUIRE_EQUAL(2,blocks_read);
+    BOOST_REQUIRE_EQUAL(800,first_id);
+    BOOST_REQUIRE_EQUAL(200,records);
+
+    // Columns missing from every record never match
+    BOOST_REQUIRE_EQUAL(0,filtered_reader.for_each_matching(zones,7,turbo_csv::zone_op::equal,1,[](auto&){}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()